@@ -0,0 +1,95 @@
+#ifndef ORDERBOOK_BENCHCOMMON_H
+#define ORDERBOOK_BENCHCOMMON_H
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "Book.h"
+
+// Shared by the benchmarks: the book variants they compare and the seeded order flow they replay
+
+constexpr Price MID_PRICE = 85000; /**< Mid of demo/generate_orders_plus.py */
+constexpr double BAND_RATIO = 0.08; /**< Half-width of its price band */
+
+/** Price level structures of a book, named in the benchmark labels by variant_name */
+enum BookVariant { MAP_TREE, LADDER, MAP_BITMAP, LADDER_BITMAP, MAP_TREE_QUEUE, LADDER_BITMAP_QUEUE };
+
+/**
+ * @brief Builds the configuration of a book variant
+ * @param variant level structures to enable
+ * @param mid reference price of the band (see BookConfig::band_around)
+ * @param band_ratio half-width of the band relative to mid
+ * @return the corresponding configuration
+ */
+inline BookConfig make_config(BookVariant variant, Price mid = MID_PRICE, double band_ratio = BAND_RATIO) {
+	BookConfig config = BookConfig::band_around(mid, band_ratio);
+	config.use_ladder = variant == LADDER or variant == LADDER_BITMAP or variant == LADDER_BITMAP_QUEUE;
+	config.use_bitmap = variant == MAP_BITMAP or variant == LADDER_BITMAP or variant == LADDER_BITMAP_QUEUE;
+	config.queue_levels = variant == MAP_TREE_QUEUE or variant == LADDER_BITMAP_QUEUE;
+	return config;
+}
+
+inline const char* variant_name(BookVariant variant) {
+	switch (variant) {
+		case LADDER: return "ladder";
+		case MAP_BITMAP: return "map+bitmap";
+		case LADDER_BITMAP: return "ladder+bitmap";
+		case MAP_TREE_QUEUE: return "map+tree+queue";
+		case LADDER_BITMAP_QUEUE: return "ladder+bitmap+queue";
+		default: return "map+tree";
+	}
+}
+
+/** Shape of the order flow built by generate_flow. The defaults are the distributions of demo/generate_orders.py. */
+struct FlowConfig {
+	double place_ratio = 0.8; /**< Share of new orders, the other commands cancel a random resting order of the same symbol */
+	Price mid = 500; /**< Reference price of the flow */
+	double spread_ratio = 0.25; /**< Distance of the mean buy (below) and sell (above) prices to mid, relative to mid */
+	double deviation_ratio = 0.2; /**< Standard deviation of the prices, relative to mid */
+	bool passive = false; /**< Keeps the buys below mid and the sells at or above it, so that no order crosses */
+	Symbol nb_symbols = 1; /**< Each command goes to a symbol drawn uniformly in [0, nb_symbols) */
+	ID first_id = 1; /**< Id of the first new order, the next ones being consecutive */
+	ID agent_id = 0; /**< Agent of every new order */
+};
+
+/**
+ * @brief Builds a seeded order flow: new orders with prices ~ N(mid -/+ spread, deviation) and volumes max(1, N(100, 300)),
+ * mixed with cancels of random resting orders (which may have been filled since)
+ * @param nb_commands number of commands
+ * @param seed seed of the generator, the same seed giving the same flow
+ * @param config shape of the flow
+ * @return the commands
+ */
+inline Commands generate_flow(std::size_t nb_commands, std::uint64_t seed, const FlowConfig& config = {}) {
+	std::mt19937_64 rng(seed);
+	std::uniform_real_distribution<double> coin(0, 1);
+	std::normal_distribution<double> volume(100, 300);
+	const double spread = config.mid * config.spread_ratio;
+	const double deviation = config.mid * config.deviation_ratio;
+	std::vector<std::vector<ID>> resting(std::max<Symbol>(config.nb_symbols, 1));
+	Commands commands;
+	commands.reserve(nb_commands);
+	ID id = config.first_id;
+	for (std::size_t i = 0; i < nb_commands; i++) {
+		// 只有一个品种时不抽品种, 单品种的序列与 generate_orders.py 的抽取顺序一致
+		Symbol symbol = resting.size() > 1 ? static_cast<Symbol>(rng() % resting.size()) : 0;
+		std::vector<ID>& ids = resting[symbol];
+		if (coin(rng) < config.place_ratio or ids.empty()) {
+			OrderType side = coin(rng) < 0.5 ? BUY : SELL;
+			std::normal_distribution<double> price(side == SELL ? config.mid + spread : config.mid - spread, deviation);
+			double drawn = std::max(1.0, price(rng));
+			if (config.passive)
+				drawn = side == BUY ? std::min(drawn, config.mid - 1.0) : std::max(drawn, double(config.mid));
+			commands.push_back({id, config.agent_id, static_cast<Volume>(std::max(1.0, volume(rng))), static_cast<Price>(drawn), PLACE, side, symbol});
+			ids.push_back(id++);
+		} else {
+			std::size_t index = rng() % ids.size();
+			commands.push_back({ids[index], config.agent_id, 0, 0, CANCEL, BUY, symbol});
+			ids[index] = ids.back();
+			ids.pop_back();
+		}
+	}
+	return commands;
+}
+
+#endif //ORDERBOOK_BENCHCOMMON_H
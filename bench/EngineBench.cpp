@@ -0,0 +1,40 @@
+#include <benchmark/benchmark.h>
+#include <thread>
+#include "BenchCommon.h"
+#include "MatchingEngine.h"
+
+// Multi-symbol replay through MatchingEngine with `range(0)` pinned workers: one producer thread submits an interleaved
+// flow over 256 symbols, throughput is the number of commands per second of wall-clock time until every worker is done.
+// With enough cores, it should grow about linearly with the number of workers as long as the producer keeps up.
+
+namespace {
+
+constexpr Symbol NB_SYMBOLS = 256;
+
+void BM_EngineReplay(benchmark::State& state) {
+	static const Commands commands = generate_flow(2'000'000, 2024, {.nb_symbols = NB_SYMBOLS});
+	EngineConfig config;
+	config.nb_workers = state.range(0);
+	config.publish_results = false;
+	config.publish_trades = false;
+	config.book_config = make_config(LADDER, 500, 1.0);
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto engine = std::make_unique<MatchingEngine>(config);
+		engine->start();
+		state.ResumeTiming();
+		for (const Command& command : commands)
+			while (not engine->submit(command)) {}
+		engine->stop();
+		state.PauseTiming();
+		engine.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * commands.size());
+	if (config.nb_workers > std::thread::hardware_concurrency())
+		state.SetLabel("more workers than cores");
+}
+
+} // namespace
+
+BENCHMARK(BM_EngineReplay)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <unistd.h>
+#include "Book.h"
+
+// Deep books: `range(0)` resting orders spread over 10000 buy levels, far more than the caches hold.
+// Reports the resident memory taken by the book per order, then the cost of cancelling random orders and of
+// sweeping the top of the book once the working set is bound by memory.
+
+namespace {
+
+constexpr Price TOP = 200000;
+constexpr Price DEPTH = 10000;
+
+std::size_t resident_bytes() {
+	std::size_t pages = 0, resident = 0;
+	std::ifstream("/proc/self/statm") >> pages >> resident;
+	return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+void fill_deep_book(Book& book, ID nb_orders) {
+	std::mt19937_64 rng(7);
+	for (ID id = 0; id < nb_orders; id++)
+		book.place_order(id, id % 64, BUY, TOP - static_cast<Price>(rng() % DEPTH), 10);
+}
+
+void BM_DeepBookBuild(benchmark::State& state) {
+	const ID nb_orders = state.range(0);
+	for (auto _ : state) {
+		std::size_t before = resident_bytes();
+		auto book = std::make_unique<Book>();
+		fill_deep_book(*book, nb_orders);
+		state.PauseTiming(); // Tearing the book down is not part of the measure
+		state.counters["bytes_per_order"] = static_cast<double>(resident_bytes() - before) / nb_orders;
+		book.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * nb_orders);
+}
+
+void BM_DeepBookCancel(benchmark::State& state) {
+	const ID nb_orders = state.range(0);
+	Book book;
+	fill_deep_book(book, nb_orders);
+	ID i = 0;
+	for (auto _ : state) {
+		book.delete_order(i++ * 2654435761 % nb_orders); // Distinct ids in random order (odd multiplier)
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DeepBookSweep(benchmark::State& state) {
+	const ID nb_orders = state.range(0);
+	constexpr Volume SWEPT_ORDERS = 1000;
+	Book book;
+	fill_deep_book(book, nb_orders);
+	Volume traded = 0;
+	ID id = nb_orders;
+	for (auto _ : state) {
+		book.place_order(id++, 0, SELL, 1, 10 * SWEPT_ORDERS, [&traded](const Trade& trade) { traded += trade.get_volume(); });
+	}
+	benchmark::DoNotOptimize(traded);
+	state.SetItemsProcessed(state.iterations() * SWEPT_ORDERS);
+}
+
+} // namespace
+
+BENCHMARK(BM_DeepBookBuild)->Arg(10'000'000)->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DeepBookCancel)->Arg(10'000'000)->Iterations(1'000'000);
+BENCHMARK(BM_DeepBookSweep)->Arg(10'000'000)->Iterations(2000);
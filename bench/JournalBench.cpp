@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include "BenchCommon.h"
+#include "Journal.h"
+
+// Matcher throughput on a mixed order flow (30% cancels) of `FLOW_SIZE` commands executed in process_batch windows of 64,
+// with the command journal off, on without sync (records reach the page cache) or on with fdatasync per group commit.
+// Only the matcher thread is timed; the counters are the group commits per iteration and the commands per group commit.
+
+namespace {
+
+enum JournalMode { OFF, PAGE_CACHE, FDATASYNC };
+
+constexpr std::size_t FLOW_SIZE = 1'000'000;
+
+void BM_Journal(benchmark::State& state) {
+	const JournalMode mode = static_cast<JournalMode>(state.range(0));
+	static const Commands commands = generate_flow(FLOW_SIZE, 42, {.place_ratio = 0.7});
+	const std::string path = (std::filesystem::temp_directory_path() / "orderbook_bench.journal").string();
+	std::uint64_t commits = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto book = std::make_unique<Book>();
+		std::filesystem::remove(path);
+		Journal journal(mode == FDATASYNC);
+		if (mode != OFF) {
+			journal.open(path);
+			journal.start();
+		}
+		state.ResumeTiming();
+
+		for (std::size_t first = 0; first < commands.size(); first += 64) {
+			std::span<const Command> batch = std::span(commands).subspan(first, std::min<std::size_t>(64, commands.size() - first));
+			if (mode != OFF)
+				journal.append(batch);
+			book->process_batch(batch, [](const Trade&) {});
+		}
+
+		state.PauseTiming();
+		journal.stop();
+		commits += journal.get_commits();
+		book.reset();
+		state.ResumeTiming();
+	}
+	std::filesystem::remove(path);
+	state.SetItemsProcessed(state.iterations() * commands.size());
+	state.counters["commits"] = benchmark::Counter(commits, benchmark::Counter::kAvgIterations);
+	state.counters["per_commit"] = commits ? static_cast<double>(state.iterations() * commands.size()) / commits : 0;
+	state.SetLabel(mode == OFF ? "off" : mode == PAGE_CACHE ? "no sync" : "fdatasync");
+}
+
+} // namespace
+
+BENCHMARK(BM_Journal)->DenseRange(OFF, FDATASYNC)->Unit(benchmark::kMillisecond);
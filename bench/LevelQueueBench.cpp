@@ -0,0 +1,95 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include "BenchCommon.h"
+
+// Linked-list limits against queued limits (BookConfig::queue_levels). `range(0)` resting sell orders are placed over
+// 1000 levels in random level order, so the orders of one level are scattered over the order pool as in a real flow.
+
+namespace {
+
+constexpr Price BASE = 100000;
+constexpr Price NB_LEVELS = 1000;
+
+// One limit on its own: `range(0)` orders in shuffled pool slots, 1000 of them filled (and given back to the pool) per
+// iteration then replaced. Isolates the cost of walking the level from the id map and price index of the Book.
+template<BookVariant Storage>
+void BM_LevelMatch(benchmark::State& state) {
+	const ID nb_resting = state.range(0);
+	constexpr Volume SWEPT_ORDERS = 1000;
+	OrderPool pool;
+	std::vector<OrderIndex> indices(nb_resting);
+	for (ID id = 0; id < nb_resting; id++)
+		indices[id] = pool.construct(id, SELL, BASE, 10);
+	std::shuffle(indices.begin(), indices.end(), std::mt19937_64(5));
+	Limit limit(BASE, pool, make_config(Storage).queue_levels);
+	for (OrderIndex index : indices)
+		limit.insert_order(index);
+
+	Volume traded = 0;
+	ID id = nb_resting;
+	for (auto _ : state) {
+		Order incoming(id++, BUY, BASE, 10 * SWEPT_ORDERS);
+		limit.match_order(&incoming, [&traded](const Trade& trade) { traded += trade.get_volume(); }, [&pool](OrderIndex index) { pool.destroy(index); });
+		state.PauseTiming();
+		for (Volume i = 0; i < SWEPT_ORDERS; i++)
+			limit.insert_order(pool.construct(id++, SELL, BASE, 10));
+		state.ResumeTiming();
+	}
+	benchmark::DoNotOptimize(traded);
+	state.SetItemsProcessed(state.iterations() * SWEPT_ORDERS);
+}
+
+// Sweep-heavy: each aggressive order fills 1000 resting orders, about one level
+template<BookVariant Storage>
+void BM_QueueSweep(benchmark::State& state) {
+	const ID nb_resting = state.range(0);
+	constexpr Volume SWEPT_ORDERS = 1000;
+	Book book(make_config(Storage));
+	std::mt19937_64 rng(3);
+	for (ID id = 0; id < nb_resting; id++)
+		book.place_order(id, 0, SELL, BASE + static_cast<Price>(rng() % NB_LEVELS), 10);
+
+	Volume traded = 0;
+	ID id = nb_resting;
+	for (auto _ : state)
+		book.place_order(id++, 0, BUY, BASE + NB_LEVELS, 10 * SWEPT_ORDERS, [&traded](const Trade& trade) { traded += trade.get_volume(); });
+	benchmark::DoNotOptimize(traded);
+	state.SetItemsProcessed(state.iterations() * SWEPT_ORDERS);
+}
+
+// Cancel-heavy: per step, 4 random orders are cancelled and replaced, then an aggressive order fills the 4 oldest
+// orders of the best level (replaced as well), so matching keeps walking over the tombstones the cancels left
+template<BookVariant Storage>
+void BM_QueueCancelHeavy(benchmark::State& state) {
+	const ID nb_resting = state.range(0);
+	Book book(make_config(Storage));
+	Trades trades;
+	std::mt19937_64 rng(4);
+	std::vector<OrderHandle> resting(nb_resting);
+	for (ID id = 0; id < nb_resting; id++)
+		resting[id] = book.place_order(id, 0, SELL, BASE + static_cast<Price>(rng() % NB_LEVELS), 10, trades).handle;
+
+	ID id = nb_resting;
+	for (auto _ : state) {
+		for (int i = 0; i < 4; i++) {
+			std::size_t index = rng() % nb_resting;
+			book.cancel(resting[index]); // May be stale if the order was filled: it is replaced all the same
+			resting[index] = book.place_order(id++, 0, SELL, BASE + static_cast<Price>(rng() % NB_LEVELS), 10, trades).handle;
+		}
+		trades.clear();
+		book.place_order(id++, 0, BUY, BASE + NB_LEVELS, 40, trades);
+		for (int i = 0; i < 4; i++)
+			book.place_order(id++, 0, SELL, BASE + static_cast<Price>(rng() % NB_LEVELS), 10, trades);
+	}
+	state.SetItemsProcessed(state.iterations() * 4);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_LevelMatch, MAP_TREE)->Arg(1'000'000);
+BENCHMARK_TEMPLATE(BM_LevelMatch, MAP_TREE_QUEUE)->Arg(1'000'000);
+BENCHMARK_TEMPLATE(BM_QueueSweep, MAP_TREE)->Arg(1'000'000)->Iterations(500);
+BENCHMARK_TEMPLATE(BM_QueueSweep, MAP_TREE_QUEUE)->Arg(1'000'000)->Iterations(500);
+BENCHMARK_TEMPLATE(BM_QueueCancelHeavy, MAP_TREE)->Arg(100'000)->Arg(1'000'000);
+BENCHMARK_TEMPLATE(BM_QueueCancelHeavy, MAP_TREE_QUEUE)->Arg(100'000)->Arg(1'000'000);
@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <random>
+#include "Book.h"
+#include "boost/pool/object_pool.hpp"
+
+// Order allocators: boost::object_pool (ordered_free, linear in its free list) against SlabPool (O(1) release).
+// `range(0)` orders are allocated and half of them are cancelled, then a random live one is replaced per iteration,
+// as a cancel-heavy flow does once the book has shrunk. boost allocates from the lowest free address, so its free list
+// only shortens slowly: the iteration count is fixed so that every size is measured over the same window.
+
+namespace {
+
+struct BoostOrderPool {
+	boost::object_pool<Order> pool{2048};
+	Order* construct(ID id) { return new(pool.malloc()) Order(id, BUY, 100, 10); } // Same malloc + placement new as Book used
+	void destroy(Order* order) { pool.destroy(order); }
+};
+
+struct SlabOrderPool {
+	SlabPool<Order> pool{4096};
+	Order* construct(ID id) { return pool.construct(id, BUY, 100, 10); }
+	void destroy(Order* order) { pool.destroy(order); }
+};
+
+template<typename Pool>
+void BM_PoolCancelReplace(benchmark::State& state) {
+	const std::size_t nb_orders = state.range(0);
+	Pool pool;
+	std::vector<Order*> orders(nb_orders);
+	for (std::size_t i = 0; i < nb_orders; i++)
+		orders[i] = pool.construct(i);
+	// Cancel every other order, highest address first so that building the boost free list stays linear
+	std::vector<Order*> live, cancelled;
+	for (std::size_t i = 0; i < nb_orders; i++)
+		(i % 2 ? live : cancelled).push_back(orders[i]);
+	std::sort(cancelled.begin(), cancelled.end(), std::greater<>());
+	for (Order* order : cancelled)
+		pool.destroy(order);
+
+	const std::size_t nb_live = live.size();
+	std::mt19937_64 rng(1);
+	ID id = nb_orders;
+	for (auto _ : state) {
+		std::size_t index = rng() % nb_live;
+		pool.destroy(live[index]);
+		live[index] = pool.construct(id++);
+	}
+	// Live orders are left to the pool: boost destroys them itself, SlabPool releases its slabs
+	state.SetItemsProcessed(state.iterations());
+}
+
+// Book::delete_order(ID) + place_order on a book holding `range(0)` resting orders spread over 2000 levels
+void BM_BookCancel(benchmark::State& state) {
+	const std::size_t nb_resting = state.range(0);
+	BookConfig config;
+	config.reserved_orders = nb_resting;
+	Book book(config);
+	std::mt19937_64 rng(2);
+	std::vector<ID> resting(nb_resting);
+	for (std::size_t i = 0; i < nb_resting; i++) {
+		resting[i] = i;
+		book.place_order(i, 0, BUY, 80000 + rng() % 2000, 10);
+	}
+
+	ID id = nb_resting;
+	for (auto _ : state) {
+		std::size_t index = rng() % nb_resting;
+		book.delete_order(resting[index]);
+		book.place_order(id, 0, BUY, 80000 + rng() % 2000, 10);
+		resting[index] = id++;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+// Same flow, cancelling through the handles returned by place_order instead of the ids
+void BM_BookCancelHandle(benchmark::State& state) {
+	const std::size_t nb_resting = state.range(0);
+	BookConfig config;
+	config.reserved_orders = nb_resting;
+	Book book(config);
+	Trades trades;
+	std::mt19937_64 rng(2);
+	std::vector<OrderHandle> resting(nb_resting);
+	for (std::size_t i = 0; i < nb_resting; i++)
+		resting[i] = book.place_order(i, 0, BUY, 80000 + rng() % 2000, 10, trades).handle;
+
+	ID id = nb_resting;
+	for (auto _ : state) {
+		std::size_t index = rng() % nb_resting;
+		book.cancel(resting[index]);
+		resting[index] = book.place_order(id++, 0, BUY, 80000 + rng() % 2000, 10, trades).handle;
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_PoolCancelReplace, BoostOrderPool)->RangeMultiplier(10)->Range(1'000, 1'000'000)->Iterations(2000);
+BENCHMARK_TEMPLATE(BM_PoolCancelReplace, SlabOrderPool)->RangeMultiplier(10)->Range(1'000, 1'000'000)->Iterations(2000);
+BENCHMARK(BM_BookCancel)->RangeMultiplier(10)->Range(1'000, 1'000'000);
+BENCHMARK(BM_BookCancelHandle)->RangeMultiplier(10)->Range(1'000, 1'000'000);
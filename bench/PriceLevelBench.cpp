@@ -0,0 +1,135 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <random>
+#include "BenchCommon.h"
+
+// Price levels: hash map + tree (default) against the dense tick ladder and the occupancy bitmap.
+// Prices follow demo/generate_orders_plus.py: mid 85000, band +/- 8%.
+
+namespace {
+
+// Resting orders on both sides without crossing: buys below the mid, sells above, [first_offset, last_offset] ticks away
+void fill_book(Book& book, std::size_t nb_orders, Price first_offset, Price last_offset, std::uint64_t seed, ID first_id = 1) {
+	std::mt19937_64 rng(seed);
+	std::uniform_int_distribution<Price> offset(first_offset, last_offset);
+	for (std::size_t i = 0; i < nb_orders; i++) {
+		bool is_buy = i % 2 == 0;
+		Price price = is_buy ? MID_PRICE - offset(rng) : MID_PRICE + offset(rng);
+		book.place_order(first_id + i, 0, is_buy ? BUY : SELL, price, 100);
+	}
+}
+
+// Inserting passive orders into an empty book: every new price creates a level
+template<BookVariant Mode>
+void BM_PassiveInsert(benchmark::State& state) {
+	const std::size_t nb_orders = state.range(0);
+	const Price width = static_cast<Price>(state.range(1));
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto book = std::make_unique<Book>(make_config(Mode));
+		state.ResumeTiming();
+		fill_book(*book, nb_orders, 1, width, 42);
+		state.PauseTiming();
+		book.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * nb_orders);
+	state.SetLabel(variant_name(Mode));
+}
+
+// Placing then cancelling an order on an empty price: one level created and destroyed per iteration
+template<BookVariant Mode>
+void BM_LevelChurn(benchmark::State& state) {
+	Book book(make_config(Mode));
+	fill_book(book, 100'000, 1, 2000, 7);
+	std::mt19937_64 rng(11);
+	std::uniform_int_distribution<Price> offset(2001, 4000);
+	ID id = 1'000'000;
+	for (auto _ : state) {
+		Price price = MID_PRICE - offset(rng);
+		book.place_order(id, 0, BUY, price, 100);
+		book.delete_order(id);
+		id++;
+	}
+	state.SetItemsProcessed(state.iterations() * 2);
+	state.SetLabel(variant_name(Mode));
+}
+
+// One aggressive order sweeping `range(0)` consecutive sell levels, one order each
+template<BookVariant Mode>
+void BM_Sweep(benchmark::State& state) {
+	const Price nb_levels = static_cast<Price>(state.range(0));
+	Book book(make_config(Mode));
+	fill_book(book, 20'000, 1001, 2000, 3, ID(1) << 40); // Background depth on both sides, behind the swept levels
+	ID id = 1;
+	for (auto _ : state) {
+		state.PauseTiming();
+		for (Price level = 1; level <= nb_levels; level++)
+			book.place_order(id++, 0, SELL, MID_PRICE + level, 10);
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(book.place_order(id++, 0, BUY, MID_PRICE + nb_levels, 10 * nb_levels));
+	}
+	state.SetItemsProcessed(state.iterations() * nb_levels);
+	state.SetLabel(variant_name(Mode));
+}
+
+// Generator-like flow around the mid: limit orders near the touch, about 10% of them crossing the spread, and 30% cancels
+// of random resting orders
+template<BookVariant Mode>
+void BM_MixedFlow(benchmark::State& state) {
+	static const Commands commands = generate_flow(200'000, 2024, {.place_ratio = 0.7, .mid = MID_PRICE, .spread_ratio = 0.005, .deviation_ratio = 0.004});
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto book = std::make_unique<Book>(make_config(Mode));
+		state.ResumeTiming();
+		for (const Command& command : commands) {
+			if (command.type == PLACE)
+				book->place_order(command.id, command.agent_id, command.side, command.price, command.volume);
+			else
+				book->delete_order(command.id);
+		}
+		state.PauseTiming();
+		book.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * commands.size());
+	state.SetLabel(variant_name(Mode));
+}
+
+// One aggressive order emptying the best level, the next one being `range(0)` ticks behind: best price recovery
+template<BookVariant Mode>
+void BM_BestRecovery(benchmark::State& state) {
+	const Price gap = static_cast<Price>(state.range(0));
+	Book book(make_config(Mode));
+	fill_book(book, 20'000, gap + 1, gap + 1000, 5, ID(1) << 40);
+	ID id = 1;
+	for (auto _ : state) {
+		book.place_order(id++, 0, SELL, MID_PRICE + 1, 10);
+		book.place_order(id++, 0, BUY, MID_PRICE + 1, 10);
+	}
+	state.SetItemsProcessed(state.iterations());
+	state.SetLabel(variant_name(Mode));
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_PassiveInsert, MAP_TREE)->Args({100'000, 500})->Args({100'000, 5000})->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_PassiveInsert, LADDER)->Args({100'000, 500})->Args({100'000, 5000})->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_PassiveInsert, MAP_BITMAP)->Args({100'000, 500})->Args({100'000, 5000})->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_PassiveInsert, LADDER_BITMAP)->Args({100'000, 500})->Args({100'000, 5000})->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_LevelChurn, MAP_TREE);
+BENCHMARK_TEMPLATE(BM_LevelChurn, LADDER);
+BENCHMARK_TEMPLATE(BM_LevelChurn, MAP_BITMAP);
+BENCHMARK_TEMPLATE(BM_LevelChurn, LADDER_BITMAP);
+BENCHMARK_TEMPLATE(BM_Sweep, MAP_TREE)->Arg(1)->Arg(5)->Arg(50);
+BENCHMARK_TEMPLATE(BM_Sweep, LADDER)->Arg(1)->Arg(5)->Arg(50);
+BENCHMARK_TEMPLATE(BM_Sweep, MAP_BITMAP)->Arg(1)->Arg(5)->Arg(50);
+BENCHMARK_TEMPLATE(BM_Sweep, LADDER_BITMAP)->Arg(1)->Arg(5)->Arg(50);
+BENCHMARK_TEMPLATE(BM_BestRecovery, MAP_TREE)->Arg(1)->Arg(100)->Arg(5000);
+BENCHMARK_TEMPLATE(BM_BestRecovery, LADDER)->Arg(1)->Arg(100)->Arg(5000);
+BENCHMARK_TEMPLATE(BM_BestRecovery, MAP_BITMAP)->Arg(1)->Arg(100)->Arg(5000);
+BENCHMARK_TEMPLATE(BM_BestRecovery, LADDER_BITMAP)->Arg(1)->Arg(100)->Arg(5000);
+BENCHMARK_TEMPLATE(BM_MixedFlow, MAP_TREE)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MixedFlow, LADDER)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MixedFlow, MAP_BITMAP)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_MixedFlow, LADDER_BITMAP)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,112 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "BenchCommon.h"
+#include "Sequencer.h"
+
+// `range(0)` gateway threads submitting to one book, either through the Sequencer (lock-free claim + publish, one
+// matcher thread executing) or by calling the book under a std::mutex. Throughput counts the commands per second of
+// wall-clock time until the book has executed all of them. The p50/p99/p99.9 counters are the time from a submission
+// until the book has executed the command: for the mutex, waiting for the lock plus the book call; for the sequencer,
+// until the end of the matcher batch holding it (stamped by the batch listener). The sequencer also reports its submit
+// cost (claim + publish, the time a gateway thread is busy) as submit_p50/p99/p99.9. Each gateway sends its own
+// seeded generate_flow, its order ids tagged with its index in the high bits.
+
+namespace {
+
+enum Ingress { MUTEX, SEQUENCER };
+
+constexpr std::size_t PER_PRODUCER = 50'000;
+
+std::int64_t now_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/** Sets the p50/p99/p99.9 counters of a set of durations, their names starting with prefix */
+void set_percentiles(benchmark::State& state, const std::string& prefix, std::vector<std::int64_t>& durations) {
+	std::sort(durations.begin(), durations.end());
+	state.counters[prefix + "p50_ns"] = static_cast<double>(durations[durations.size() / 2]);
+	state.counters[prefix + "p99_ns"] = static_cast<double>(durations[durations.size() * 99 / 100]);
+	state.counters[prefix + "p99.9_ns"] = static_cast<double>(durations[durations.size() * 999 / 1000]);
+}
+
+template<Ingress I>
+void BM_Ingress(benchmark::State& state) {
+	const std::size_t nb_producers = state.range(0);
+	std::vector<Commands> flows;
+	for (ID producer = 0; producer < nb_producers; producer++)
+		flows.push_back(generate_flow(PER_PRODUCER, producer, {.first_id = producer << 40 | 1, .agent_id = producer}));
+	// Per gateway and command: submission time, sequence number and time spent in the call
+	std::vector<std::vector<std::int64_t>> started(nb_producers, std::vector<std::int64_t>(PER_PRODUCER));
+	std::vector<std::vector<std::uint64_t>> sequences(nb_producers, std::vector<std::uint64_t>(PER_PRODUCER));
+	std::vector<std::vector<std::int64_t>> in_call(nb_producers, std::vector<std::int64_t>(PER_PRODUCER));
+	// Execution time of each command by sequence number, written by the matcher thread after each batch
+	std::vector<std::int64_t> executed_at(nb_producers * PER_PRODUCER);
+	auto on_batch = [&executed_at](std::span<const SequencedCommand> commands, std::span<const PlaceResult>, std::span<const Trade>) {
+		std::int64_t now = now_ns();
+		for (const SequencedCommand& command : commands)
+			executed_at[command.sequence] = now;
+	};
+
+	for (auto _ : state) {
+		state.PauseTiming();
+		Book book;
+		std::mutex mutex;
+		Sequencer sequencer(book, 1 << 16, on_batch);
+		if constexpr (I == SEQUENCER)
+			sequencer.start();
+		state.ResumeTiming();
+
+		std::vector<std::thread> producers;
+		for (std::size_t producer = 0; producer < nb_producers; producer++) {
+			producers.emplace_back([&, producer]() {
+				for (std::size_t i = 0; i < PER_PRODUCER; i++) {
+					const Command& command = flows[producer][i];
+					std::int64_t start = now_ns();
+					if constexpr (I == SEQUENCER) {
+						sequences[producer][i] = sequencer.submit(command);
+					} else {
+						std::lock_guard<std::mutex> lock(mutex);
+						if (command.type == PLACE)
+							book.place_order(command.id, command.agent_id, command.side, command.price, command.volume, [](const Trade&) {});
+						else
+							book.delete_order(command.id);
+					}
+					in_call[producer][i] = now_ns() - start;
+					started[producer][i] = start;
+				}
+			});
+		}
+		for (std::thread& producer : producers)
+			producer.join();
+		if constexpr (I == SEQUENCER)
+			sequencer.stop(); // Returns once every submitted command is executed
+
+		state.PauseTiming();
+		std::vector<std::int64_t> latencies;
+		std::vector<std::int64_t> submit_costs;
+		for (std::size_t producer = 0; producer < nb_producers; producer++) {
+			if constexpr (I == SEQUENCER) {
+				for (std::size_t i = 0; i < PER_PRODUCER; i++)
+					latencies.push_back(executed_at[sequences[producer][i]] - started[producer][i]);
+				submit_costs.insert(submit_costs.end(), in_call[producer].begin(), in_call[producer].end());
+			} else {
+				latencies.insert(latencies.end(), in_call[producer].begin(), in_call[producer].end());
+			}
+		}
+		set_percentiles(state, "", latencies);
+		if constexpr (I == SEQUENCER)
+			set_percentiles(state, "submit_", submit_costs);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * nb_producers * PER_PRODUCER);
+	state.SetLabel(I == SEQUENCER ? "sequencer" : "mutex");
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Ingress, MUTEX)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Ingress, SEQUENCER)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,68 @@
+#include <benchmark/benchmark.h>
+#include <filesystem>
+#include <memory>
+#include "BenchCommon.h"
+
+// Startup cost of a book of `range(0)` resting orders (generate_flow without cancels nor crossing orders): rebuilding it
+// by placing every order again, or loading a snapshot of it (file in the page cache after the first iteration). Saving
+// is timed too.
+
+namespace {
+
+const FlowConfig RESTING = {.place_ratio = 1.0, .passive = true}; /**< Every order of the flow rests in the book */
+
+std::string snapshot_path(std::size_t nb_orders) {
+	return (std::filesystem::temp_directory_path() / ("orderbook_bench_" + std::to_string(nb_orders) + ".snapshot")).string();
+}
+
+/** Rebuilds the book by placing every order, 64 at a time through process_batch */
+void replay_into(Book& book, const Commands& commands) {
+	for (std::size_t first = 0; first < commands.size(); first += 64)
+		book.process_batch(std::span(commands).subspan(first, std::min<std::size_t>(64, commands.size() - first)), [](const Trade&) {});
+}
+
+void BM_RebuildByReplay(benchmark::State& state) {
+	Commands commands = generate_flow(state.range(0), 7, RESTING);
+	for (auto _ : state) {
+		auto book = std::make_unique<Book>();
+		replay_into(*book, commands);
+		state.PauseTiming();
+		book.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * commands.size());
+}
+
+void BM_SaveSnapshot(benchmark::State& state) {
+	Book book;
+	replay_into(book, generate_flow(state.range(0), 7, RESTING));
+	std::string path = snapshot_path(state.range(0));
+	for (auto _ : state)
+		benchmark::DoNotOptimize(book.save_snapshot(path));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_LoadSnapshot(benchmark::State& state) {
+	std::string path = snapshot_path(state.range(0));
+	{
+		Book book;
+		replay_into(book, generate_flow(state.range(0), 7, RESTING));
+		book.save_snapshot(path);
+	}
+	for (auto _ : state) {
+		auto book = std::make_unique<Book>();
+		if (not book->load_snapshot(path))
+			state.SkipWithError("snapshot not loaded");
+		state.PauseTiming();
+		book.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	std::filesystem::remove(path);
+}
+
+} // namespace
+
+BENCHMARK(BM_RebuildByReplay)->Arg(1'000'000)->Arg(4'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SaveSnapshot)->Arg(1'000'000)->Arg(4'000'000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_LoadSnapshot)->Arg(1'000'000)->Arg(4'000'000)->Arg(10'000'000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+#include "Book.h"
+
+// Aggressive orders sweeping `range(0)` resting orders (10 per level) on a book that also holds `range(1)` unrelated
+// resting orders, so that the id -> order map is much larger than the cache. Every swept order is fully filled and has to
+// be erased from the map and given back to the pool.
+
+namespace {
+
+void BM_LargeSweep(benchmark::State& state) {
+	const ID nb_swept = state.range(0);
+	const ID nb_background = state.range(1);
+	BookConfig config;
+	config.reserved_orders = nb_background + nb_swept + 1;
+	Book book(config);
+	for (ID i = 0; i < nb_background; i++)
+		book.place_order(ID(1) << 40 | i, 0, BUY, 50000 - static_cast<Price>(i % 1000), 10);
+
+	Volume traded = 0;
+	ID id = 1;
+	for (auto _ : state) {
+		state.PauseTiming();
+		for (ID i = 0; i < nb_swept; i++)
+			book.place_order(id++, 0, SELL, 60000 + static_cast<Price>(i / 10), 10);
+		state.ResumeTiming();
+		book.place_order(id++, 0, BUY, 60000 + static_cast<Price>(nb_swept / 10), 10 * nb_swept, [&traded](const Trade& trade) { traded += trade.get_volume(); });
+	}
+	benchmark::DoNotOptimize(traded);
+	state.SetItemsProcessed(state.iterations() * nb_swept);
+}
+
+} // namespace
+
+BENCHMARK(BM_LargeSweep)->ArgsProduct({{100, 1'000, 10'000}, {0, 1'000'000}});
@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+#include "Book.h"
+
+// Trade emission of an order sweeping `range(0)` levels: returned vector, reused caller buffer and sink callback.
+
+namespace {
+
+enum Emission { RETURNED_VECTOR, REUSED_BUFFER, SINK };
+
+template<Emission Mode>
+void BM_SweepEmission(benchmark::State& state) {
+	const Price nb_levels = static_cast<Price>(state.range(0));
+	Book book;
+	Trades buffer;
+	Volume traded = 0;
+	ID id = 1;
+	for (auto _ : state) {
+		state.PauseTiming();
+		for (Price level = 1; level <= nb_levels; level++)
+			book.place_order(id++, 0, SELL, 1000 + level, 10);
+		state.ResumeTiming();
+		if constexpr (Mode == RETURNED_VECTOR) {
+			Trades trades = book.place_order(id++, 0, BUY, 1000 + nb_levels, 10 * nb_levels);
+			benchmark::DoNotOptimize(trades.data());
+		} else if constexpr (Mode == REUSED_BUFFER) {
+			buffer.clear();
+			book.place_order(id++, 0, BUY, 1000 + nb_levels, 10 * nb_levels, buffer);
+			benchmark::DoNotOptimize(buffer.data());
+		} else {
+			book.place_order(id++, 0, BUY, 1000 + nb_levels, 10 * nb_levels, [&traded](const Trade& trade) { traded += trade.get_volume(); });
+		}
+	}
+	benchmark::DoNotOptimize(traded);
+	state.SetItemsProcessed(state.iterations() * nb_levels);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_SweepEmission, RETURNED_VECTOR)->Arg(1)->Arg(5)->Arg(20);
+BENCHMARK_TEMPLATE(BM_SweepEmission, REUSED_BUFFER)->Arg(1)->Arg(5)->Arg(20);
+BENCHMARK_TEMPLATE(BM_SweepEmission, SINK)->Arg(1)->Arg(5)->Arg(20);
@@ -0,0 +1,362 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include "BenchCommon.h"
+#include "ReplicaBook.h"
+
+// Per-operation workloads, each run against the engine variants so that one JSON report tracks them side by side:
+// passive inserts at new and existing levels, cancels at the head / middle / tail of a limit, sweeps across N levels,
+// the order flow of demo/generate_orders.py, alone, in process_batch windows and with a depth read or the L2 feed drained after each window, and rebuilt from the L3 feed. Variants are named by their label (see variant_name).
+
+namespace {
+
+constexpr std::size_t BATCH = 1000; /**< Operations timed between two pauses */
+
+// `BATCH` passive buys per iteration, each at a price where no order rests (the levels are removed while paused).
+// The book also holds `range(0)` resting orders below those prices.
+template<BookVariant V>
+void BM_InsertNewLevel(benchmark::State& state) {
+	const ID nb_background = state.range(0);
+	Book book(make_config(V));
+	for (ID i = 0; i < nb_background; i++)
+		book.place_order(ID(1) << 40 | i, 0, BUY, MID_PRICE - 2000 - static_cast<Price>(i % 1000), 10);
+
+	ID id = 1;
+	for (auto _ : state) {
+		const ID first = id;
+		for (std::size_t i = 0; i < BATCH; i++)
+			book.place_order(id++, 0, BUY, MID_PRICE - 1 - static_cast<Price>(i), 10);
+		state.PauseTiming();
+		for (ID cancelled = first; cancelled < id; cancelled++)
+			book.delete_order(cancelled);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * BATCH);
+	state.SetLabel(variant_name(V));
+}
+
+// `BATCH` passive buys per iteration spread over 100 levels that already hold `range(0)` orders each
+template<BookVariant V>
+void BM_InsertExistingLevel(benchmark::State& state) {
+	const ID depth = state.range(0);
+	constexpr Price NB_LEVELS = 100;
+	Book book(make_config(V));
+	for (ID i = 0; i < depth * NB_LEVELS; i++)
+		book.place_order(ID(1) << 40 | i, 0, BUY, MID_PRICE - 1 - static_cast<Price>(i % NB_LEVELS), 10);
+
+	ID id = 1;
+	for (auto _ : state) {
+		const ID first = id;
+		for (std::size_t i = 0; i < BATCH; i++)
+			book.place_order(id++, 0, BUY, MID_PRICE - 1 - static_cast<Price>(i % NB_LEVELS), 10);
+		state.PauseTiming();
+		for (ID cancelled = first; cancelled < id; cancelled++)
+			book.delete_order(cancelled);
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * BATCH);
+	state.SetLabel(variant_name(V));
+}
+
+enum QueuePosition { HEAD, MIDDLE, TAIL };
+
+// One level of `range(0)` orders: per iteration, 100 orders taken around a position of the time priority queue are
+// cancelled, then replaced at the back of the queue while paused
+template<BookVariant V, QueuePosition P>
+void BM_CancelInLevel(benchmark::State& state) {
+	const std::size_t depth = state.range(0);
+	constexpr std::size_t CANCELLED = 100;
+	Book book(make_config(V));
+	std::vector<ID> queue(depth); // Ids in time priority order
+	for (std::size_t i = 0; i < depth; i++) {
+		queue[i] = i + 1;
+		book.place_order(queue[i], 0, SELL, MID_PRICE + 1, 10);
+	}
+
+	const std::size_t first = P == HEAD ? 0 : P == MIDDLE ? (depth - CANCELLED) / 2 : depth - CANCELLED;
+	ID id = depth + 1;
+	for (auto _ : state) {
+		for (std::size_t i = first; i < first + CANCELLED; i++)
+			book.delete_order(queue[i]);
+		state.PauseTiming();
+		queue.erase(queue.begin() + first, queue.begin() + first + CANCELLED);
+		for (std::size_t i = 0; i < CANCELLED; i++) {
+			queue.push_back(id);
+			book.place_order(id++, 0, SELL, MID_PRICE + 1, 10);
+		}
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * CANCELLED);
+	state.SetLabel(variant_name(V));
+}
+
+// One aggressive buy sweeping `range(0)` consecutive sell levels of `range(1)` orders each, rebuilt while paused.
+// The IOC variant sends the same order without taking a pool slot for it.
+template<BookVariant V, OrderKind K = LIMIT>
+void BM_SweepLevels(benchmark::State& state) {
+	const Price nb_levels = static_cast<Price>(state.range(0));
+	const ID per_level = state.range(1);
+	Book book(make_config(V));
+	Volume traded = 0;
+	auto on_trade = [&traded](const Trade& trade) { traded += trade.get_volume(); };
+	ID id = 1;
+	for (auto _ : state) {
+		state.PauseTiming();
+		for (Price level = 0; level < nb_levels; level++)
+			for (ID i = 0; i < per_level; i++)
+				book.place_order(id++, 0, SELL, MID_PRICE + 1 + level, 10);
+		state.ResumeTiming();
+		book.place_order(id++, 0, BUY, K, MID_PRICE + nb_levels, 10 * per_level * nb_levels, on_trade);
+	}
+	benchmark::DoNotOptimize(traded);
+	state.SetItemsProcessed(state.iterations() * nb_levels * per_level);
+	state.SetLabel(std::string(variant_name(V)) + (K == IOC ? "/ioc" : ""));
+}
+
+// `BATCH` FOK buys per iteration asking one lot more than the `range(0)` sell levels they cross hold: every one is
+// rejected by the depth pre-check and the book never changes
+template<BookVariant V>
+void BM_FokReject(benchmark::State& state) {
+	const Price nb_levels = static_cast<Price>(state.range(0));
+	Book book(make_config(V));
+	ID id = 1;
+	for (Price level = 0; level < nb_levels; level++)
+		for (int i = 0; i < 10; i++)
+			book.place_order(id++, 0, SELL, MID_PRICE + 1 + level, 10);
+
+	Length rejected = 0;
+	for (auto _ : state) {
+		for (std::size_t i = 0; i < BATCH; i++)
+			rejected += book.place_order(id, 0, BUY, FOK, MID_PRICE + nb_levels, 100 * nb_levels + 1, [](const Trade&) {}).is_rejected();
+	}
+	benchmark::DoNotOptimize(rejected);
+	state.SetItemsProcessed(state.iterations() * BATCH);
+	state.SetLabel(variant_name(V));
+}
+
+enum AmendMode { CANCEL_REPLACE, AMEND_VOLUME, AMEND_PRICE };
+
+// `BATCH` changes per iteration to orders of two sell levels holding `range(0)` orders in total: CANCEL_REPLACE moves
+// the order to the other level with delete_order + place_order, AMEND_PRICE does the same with amend_order, and
+// AMEND_VOLUME lowers its volume by one lot in place
+template<BookVariant V, AmendMode M>
+void BM_Amend(benchmark::State& state) {
+	const ID nb_orders = state.range(0);
+	constexpr Volume VOLUME = Volume(1) << 40;
+	Book book(make_config(V));
+	std::vector<Price> prices(nb_orders + 1);
+	std::vector<Volume> volumes(nb_orders + 1, VOLUME);
+	for (ID id = 1; id <= nb_orders; id++) {
+		prices[id] = MID_PRICE + 1 + static_cast<Price>(id % 2);
+		book.place_order(id, 0, SELL, prices[id], VOLUME);
+	}
+	std::mt19937_64 rng(7);
+	std::vector<ID> targets(BATCH);
+	auto no_trade = [](const Trade&) {};
+	for (auto _ : state) {
+		state.PauseTiming();
+		for (ID& target : targets)
+			target = 1 + rng() % nb_orders;
+		state.ResumeTiming();
+		for (ID id : targets) {
+			if constexpr (M == AMEND_VOLUME) {
+				book.amend_order(id, prices[id], --volumes[id], no_trade);
+			} else {
+				prices[id] = prices[id] == MID_PRICE + 1 ? MID_PRICE + 2 : MID_PRICE + 1;
+				if constexpr (M == AMEND_PRICE) {
+					book.amend_order(id, prices[id], VOLUME, no_trade);
+				} else {
+					book.delete_order(id);
+					book.place_order(id, 0, SELL, prices[id], VOLUME, no_trade);
+				}
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * BATCH);
+	state.SetLabel(variant_name(V));
+}
+
+// Replays `range(0)` generated operations into a fresh book per iteration
+template<BookVariant V>
+void BM_GeneratorFlow(benchmark::State& state) {
+	const Commands flow = generate_flow(state.range(0), 2024);
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto book = std::make_unique<Book>(make_config(V, 500, 1.0));
+		state.ResumeTiming();
+		for (const Command& command : flow) {
+			if (command.type == PLACE)
+				book->place_order(command.id, command.agent_id, command.side, command.price, command.volume, [](const Trade&) {});
+			else
+				book->delete_order(command.id);
+		}
+		state.PauseTiming();
+		book.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * flow.size());
+	state.SetLabel(variant_name(V));
+}
+
+// Same flow as BM_GeneratorFlow, fed to Book::process_batch in windows of `range(0)` commands
+template<BookVariant V>
+void BM_BatchFlow(benchmark::State& state) {
+	const std::size_t batch_size = state.range(0);
+	const Commands commands = generate_flow(200'000, 2024);
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto book = std::make_unique<Book>(make_config(V, 500, 1.0));
+		state.ResumeTiming();
+		for (std::size_t first = 0; first < commands.size(); first += batch_size)
+			book->process_batch(std::span(commands).subspan(first, std::min(batch_size, commands.size() - first)), [](const Trade&) {});
+		state.PauseTiming();
+		book.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * commands.size());
+	state.SetLabel(variant_name(V));
+}
+
+// Same flow in windows of 64 commands, reading the 10 best levels of each side after every window, as a market data
+// publisher does: `range(0)` is BookConfig::depth_levels, 0 rebuilds the depth on each read, 10 keeps it up to date
+template<BookVariant V>
+void BM_DepthPoll(benchmark::State& state) {
+	constexpr std::size_t BATCH_SIZE = 64;
+	const Commands commands = generate_flow(200'000, 2024);
+	DepthLevel depth[10];
+	for (auto _ : state) {
+		state.PauseTiming();
+		BookConfig config = make_config(V, 500, 1.0);
+		config.depth_levels = state.range(0);
+		auto book = std::make_unique<Book>(config);
+		state.ResumeTiming();
+		for (std::size_t first = 0; first < commands.size(); first += BATCH_SIZE) {
+			book->process_batch(std::span(commands).subspan(first, std::min(BATCH_SIZE, commands.size() - first)), [](const Trade&) {});
+			benchmark::DoNotOptimize(book->get_depth(BUY, depth));
+			benchmark::DoNotOptimize(book->get_depth(SELL, depth));
+			benchmark::ClobberMemory();
+		}
+		state.PauseTiming();
+		book.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * commands.size());
+	state.SetLabel(std::string(variant_name(V)) + (state.range(0) ? "/maintained" : "/rebuilt"));
+}
+
+// Same flow in windows of 64 commands with the L2 feed drained after every window: `range(0)` is 0 for feed off, 1 for
+// updates popped and dropped (cost of the book side alone), 2 for updates applied to a LevelBook
+template<BookVariant V>
+void BM_LevelFeed(benchmark::State& state) {
+	constexpr std::size_t BATCH_SIZE = 64;
+	const Commands commands = generate_flow(200'000, 2024);
+	LevelRing ring(1 << 16);
+	LevelUpdate updates[BATCH_SIZE];
+	for (auto _ : state) {
+		state.PauseTiming();
+		auto book = std::make_unique<Book>(make_config(V, 500, 1.0));
+		LevelBook levels;
+		if (state.range(0))
+			book->set_level_feed(&ring);
+		state.ResumeTiming();
+		for (std::size_t first = 0; first < commands.size(); first += BATCH_SIZE) {
+			book->process_batch(std::span(commands).subspan(first, std::min(BATCH_SIZE, commands.size() - first)), [](const Trade&) {});
+			if (state.range(0) == 1)
+				while (ring.try_pop_bulk(updates, BATCH_SIZE)) {}
+			else
+				levels.drain(ring);
+		}
+		state.PauseTiming();
+		book.reset();
+		state.ResumeTiming();
+	}
+	state.SetItemsProcessed(state.iterations() * commands.size());
+	state.SetLabel(std::string(variant_name(V)) + (state.range(0) == 1 ? "/l2-dropped" : state.range(0) == 2 ? "/l2-applied" : ""));
+}
+
+// Rebuilding the book at the end of the same flow: `range(0)` = 0 replays the commands through the book (matching),
+// 1 applies the L3 feed the book published for them to a ReplicaBook; items are commands in both cases
+template<BookVariant V>
+void BM_Replica(benchmark::State& state) {
+	constexpr std::size_t BATCH_SIZE = 64;
+	const Commands commands = generate_flow(200'000, 2024);
+	std::vector<OrderEvent> events;
+	{
+		Book book(make_config(V, 500, 1.0));
+		OrderEventRing ring(1 << 16);
+		OrderEvent popped[BATCH_SIZE];
+		book.set_order_feed(&ring);
+		for (std::size_t first = 0; first < commands.size(); first += BATCH_SIZE) {
+			book.process_batch(std::span(commands).subspan(first, std::min(BATCH_SIZE, commands.size() - first)), [](const Trade&) {});
+			while (std::size_t count = ring.try_pop_bulk(popped, BATCH_SIZE))
+				events.insert(events.end(), popped, popped + count);
+		}
+	}
+	for (auto _ : state) {
+		if (state.range(0)) {
+			state.PauseTiming();
+			auto replica = std::make_unique<ReplicaBook>(commands.size());
+			state.ResumeTiming();
+			for (const OrderEvent& event : events)
+				replica->apply(event);
+			state.PauseTiming();
+			replica.reset();
+			state.ResumeTiming();
+		} else {
+			state.PauseTiming();
+			auto book = std::make_unique<Book>(make_config(V, 500, 1.0));
+			state.ResumeTiming();
+			for (std::size_t first = 0; first < commands.size(); first += BATCH_SIZE)
+				book->process_batch(std::span(commands).subspan(first, std::min(BATCH_SIZE, commands.size() - first)), [](const Trade&) {});
+			state.PauseTiming();
+			book.reset();
+			state.ResumeTiming();
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * commands.size());
+	state.counters["events"] = static_cast<double>(events.size());
+	state.SetLabel(state.range(0) ? "replica" : variant_name(V));
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_InsertNewLevel, MAP_TREE)->Arg(0)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_InsertNewLevel, LADDER_BITMAP)->Arg(0)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_InsertNewLevel, LADDER_BITMAP_QUEUE)->Arg(0)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_InsertExistingLevel, MAP_TREE)->Arg(10)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_InsertExistingLevel, LADDER_BITMAP)->Arg(10)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_InsertExistingLevel, LADDER_BITMAP_QUEUE)->Arg(10)->Arg(1000);
+BENCHMARK_TEMPLATE(BM_CancelInLevel, MAP_TREE, HEAD)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_CancelInLevel, MAP_TREE, MIDDLE)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_CancelInLevel, MAP_TREE, TAIL)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_CancelInLevel, LADDER_BITMAP_QUEUE, HEAD)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_CancelInLevel, LADDER_BITMAP_QUEUE, MIDDLE)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_CancelInLevel, LADDER_BITMAP_QUEUE, TAIL)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_SweepLevels, MAP_TREE)->ArgsProduct({{1, 10, 100}, {1, 10}});
+BENCHMARK_TEMPLATE(BM_SweepLevels, LADDER_BITMAP)->ArgsProduct({{1, 10, 100}, {1, 10}});
+BENCHMARK_TEMPLATE(BM_SweepLevels, LADDER_BITMAP_QUEUE)->ArgsProduct({{1, 10, 100}, {1, 10}});
+BENCHMARK_TEMPLATE(BM_SweepLevels, MAP_TREE, IOC)->ArgsProduct({{1, 10, 100}, {1, 10}});
+BENCHMARK_TEMPLATE(BM_SweepLevels, LADDER_BITMAP_QUEUE, IOC)->ArgsProduct({{1, 10, 100}, {1, 10}});
+BENCHMARK_TEMPLATE(BM_FokReject, MAP_TREE)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK_TEMPLATE(BM_FokReject, LADDER_BITMAP)->Arg(1)->Arg(10)->Arg(100);
+BENCHMARK_TEMPLATE(BM_Amend, MAP_TREE, CANCEL_REPLACE)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_Amend, MAP_TREE, AMEND_PRICE)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_Amend, MAP_TREE, AMEND_VOLUME)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_Amend, LADDER_BITMAP_QUEUE, CANCEL_REPLACE)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_Amend, LADDER_BITMAP_QUEUE, AMEND_PRICE)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_Amend, LADDER_BITMAP_QUEUE, AMEND_VOLUME)->Arg(1000)->Arg(100'000);
+BENCHMARK_TEMPLATE(BM_GeneratorFlow, MAP_TREE)->Arg(200'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GeneratorFlow, LADDER_BITMAP)->Arg(200'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_GeneratorFlow, LADDER_BITMAP_QUEUE)->Arg(200'000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BatchFlow, MAP_TREE)->RangeMultiplier(2)->Range(1, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BatchFlow, LADDER_BITMAP)->RangeMultiplier(2)->Range(1, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_BatchFlow, LADDER_BITMAP_QUEUE)->RangeMultiplier(2)->Range(1, 256)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_DepthPoll, MAP_TREE)->Arg(0)->Arg(10)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_DepthPoll, LADDER_BITMAP)->Arg(0)->Arg(10)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_DepthPoll, LADDER_BITMAP_QUEUE)->Arg(0)->Arg(10)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_LevelFeed, MAP_TREE)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_LevelFeed, LADDER_BITMAP_QUEUE)->DenseRange(0, 2)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Replica, MAP_TREE)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Replica, LADDER_BITMAP_QUEUE)->Arg(0)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,88 @@
+#include "Latency.h"
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+TscClock::TscClock(): ns_per_tick(1) {
+#if defined(__x86_64__) || defined(__i386__)
+	auto start = std::chrono::steady_clock::now();
+	std::uint64_t start_ticks = now();
+	std::chrono::steady_clock::time_point end;
+	do {
+		end = std::chrono::steady_clock::now();
+	} while (end - start < std::chrono::milliseconds(20));
+	std::uint64_t ticks = now() - start_ticks;
+	ns_per_tick = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(ticks ? ticks : 1);
+#endif
+}
+
+std::uint64_t LatencyHistogram::get_percentile(double percentile) const {
+	if (total == 0)
+		return 0;
+	if (percentile >= 100)
+		return max;
+	auto rank = static_cast<std::uint64_t>(std::ceil(percentile / 100 * static_cast<double>(total)));
+	rank = std::max<std::uint64_t>(rank, 1);
+	std::uint64_t seen = 0;
+	for (std::size_t bucket = 0; bucket < NB_BUCKETS; bucket++) {
+		seen += counts[bucket];
+		if (seen >= rank)
+			return std::min(highest_of(bucket), max);
+	}
+	return max;
+}
+
+namespace {
+
+/** Column / key of a percentile: "p99.9", "max" for 100 */
+std::string percentile_label(double percentile) {
+	if (percentile >= 100)
+		return "max";
+	std::ostringstream label;
+	label << "p" << percentile;
+	return label.str();
+}
+
+} // namespace
+
+const char* LatencyRecorder::kind_name(LatencyKind kind) {
+	switch (kind) {
+		case RESTING_INSERT: return "resting_insert";
+		case AGGRESSIVE_MATCH: return "aggressive_match";
+		case MULTI_LEVEL_SWEEP: return "sweep";
+		case CANCEL_ORDER: return "cancel";
+		case AMEND_ORDER: return "amend";
+		default: return "unknown";
+	}
+}
+
+void LatencyRecorder::print(std::ostream& out) const {
+	out << std::left << std::setw(18) << "latency (ns)" << std::right << std::setw(10) << "count" << std::setw(11) << "min";
+	for (double percentile : PERCENTILES)
+		out << std::setw(11) << percentile_label(percentile);
+	out << "\n";
+	for (std::size_t kind = 0; kind < NB_LATENCY_KINDS; kind++) {
+		const LatencyHistogram& histogram = histograms[kind];
+		if (histogram.get_total() == 0)
+			continue;
+		out << std::left << std::setw(18) << kind_name(LatencyKind(kind)) << std::right << std::setw(10) << histogram.get_total()
+				<< std::setw(11) << std::llround(clock.to_ns(histogram.get_min()));
+		for (double percentile : PERCENTILES)
+			out << std::setw(11) << std::llround(clock.to_ns(histogram.get_percentile(percentile)));
+		out << "\n";
+	}
+}
+
+void LatencyRecorder::write_json(std::ostream& out) const {
+	out << "{\n  \"unit\": \"ns\",\n  \"ns_per_tick\": " << clock.get_ns_per_tick() << ",\n  \"operations\": {";
+	for (std::size_t kind = 0; kind < NB_LATENCY_KINDS; kind++) {
+		const LatencyHistogram& histogram = histograms[kind];
+		out << (kind ? "," : "") << "\n    \"" << kind_name(LatencyKind(kind)) << "\": {\"count\": " << histogram.get_total()
+				<< ", \"min\": " << std::llround(clock.to_ns(histogram.get_min()));
+		for (double percentile : PERCENTILES)
+			out << ", \"" << percentile_label(percentile) << "\": " << std::llround(clock.to_ns(histogram.get_percentile(percentile)));
+		out << "}";
+	}
+	out << "\n  }\n}\n";
+}
@@ -0,0 +1,130 @@
+#ifndef ORDERBOOK_LATENCY_H
+#define ORDERBOOK_LATENCY_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * Cheapest monotonic clock available: the time stamp counter on x86 (a few cycles per read, no system call),
+ * std::chrono::steady_clock elsewhere. Ticks are converted to nanoseconds with a ratio measured once at start up.
+ */
+class TscClock {
+private:
+	double ns_per_tick; /**< Measured against steady_clock */
+
+public:
+	/** Calibrates the counter against steady_clock (busy waits about 20 ms) */
+	TscClock();
+
+	static std::uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+	double to_ns(std::uint64_t ticks) const { return ticks * ns_per_tick; }
+	double get_ns_per_tick() const { return ns_per_tick; }
+};
+
+/**
+ * Log-linear histogram in the spirit of HdrHistogram: values below 2 * SUB_BUCKETS are counted exactly, above that
+ * every power of two is split into SUB_BUCKETS buckets of equal width, so any value is known within 1 / SUB_BUCKETS
+ * (about 3%) while the whole 64-bit range fits in a fixed array. Recording is an index computation and an increment.
+ */
+class LatencyHistogram {
+public:
+	static constexpr unsigned SUB_BUCKET_BITS = 5;
+	static constexpr std::uint64_t SUB_BUCKETS = std::uint64_t(1) << SUB_BUCKET_BITS;
+	static constexpr std::size_t NB_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS; /**< Up to the 64-bit maximum */
+
+private:
+	std::array<std::uint64_t, NB_BUCKETS> counts{}; /**< Number of values per bucket */
+	std::uint64_t total = 0; /**< Number of values recorded */
+	std::uint64_t min = std::numeric_limits<std::uint64_t>::max(); /**< Exact smallest value */
+	std::uint64_t max = 0; /**< Exact largest value */
+
+public:
+	/**
+	 * @brief Gets the bucket of a value
+	 * @return index in counts
+	 */
+	static constexpr std::size_t bucket_of(std::uint64_t value) {
+		if (value < 2 * SUB_BUCKETS)
+			return value;
+		unsigned shift = std::bit_width(value) - SUB_BUCKET_BITS - 1; // value >> shift is in [SUB_BUCKETS, 2 * SUB_BUCKETS)
+		return (shift + 1) * SUB_BUCKETS + (value >> shift) - SUB_BUCKETS;
+	}
+	/**
+	 * @brief Gets the largest value counted in a bucket
+	 * @param bucket index in counts
+	 */
+	static constexpr std::uint64_t highest_of(std::size_t bucket) {
+		if (bucket < 2 * SUB_BUCKETS)
+			return bucket;
+		unsigned shift = bucket / SUB_BUCKETS - 1;
+		return ((bucket % SUB_BUCKETS + SUB_BUCKETS + 1) << shift) - 1;
+	}
+
+	void record(std::uint64_t value) {
+		counts[bucket_of(value)]++;
+		total++;
+		min = std::min(min, value);
+		max = std::max(max, value);
+	}
+	/**
+	 * @brief Gets the value under which a share of the recorded values fall
+	 * @param percentile share in percent, e.g. 99.9
+	 * @return the highest value of the bucket reaching that share (the exact max for 100), 0 if nothing was recorded
+	 */
+	std::uint64_t get_percentile(double percentile) const;
+
+	/** Getters */
+	std::uint64_t get_total() const { return total; }
+	std::uint64_t get_min() const { return total ? min : 0; }
+	std::uint64_t get_max() const { return max; }
+};
+
+/** Kinds of operations whose latencies are kept apart */
+enum LatencyKind : std::uint8_t { RESTING_INSERT, AGGRESSIVE_MATCH, MULTI_LEVEL_SWEEP, CANCEL_ORDER, AMEND_ORDER, NB_LATENCY_KINDS };
+
+/** Per-kind latency histograms of a replay, in clock ticks */
+class LatencyRecorder {
+private:
+	TscClock clock; /**< Clock the ticks come from */
+	std::array<LatencyHistogram, NB_LATENCY_KINDS> histograms; /**< One per kind */
+
+public:
+	/** Percentiles printed and written to the summary */
+	static constexpr std::array<double, 6> PERCENTILES = {50, 90, 99, 99.9, 99.99, 100};
+
+	static const char* kind_name(LatencyKind kind);
+
+	void record(LatencyKind kind, std::uint64_t ticks) { histograms[kind].record(ticks); }
+
+	/**
+	 * @brief Prints one line of percentiles per kind, in nanoseconds
+	 * @param out stream to print to
+	 */
+	void print(std::ostream& out) const;
+	/**
+	 * @brief Writes the count, min and percentiles of every kind as JSON, in nanoseconds
+	 * @param out stream to write to
+	 */
+	void write_json(std::ostream& out) const;
+
+	/** Getters */
+	const TscClock& get_clock() const { return clock; }
+	const LatencyHistogram& get_histogram(LatencyKind kind) const { return histograms[kind]; }
+};
+
+#endif //ORDERBOOK_LATENCY_H
@@ -0,0 +1,34 @@
+#include "Lobbin.h"
+#include <cstring>
+#include <fstream>
+
+bool write_lobbin(const std::string& path, std::span<const Command> commands) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+	LobbinHeader header{};
+	std::memcpy(header.magic, LobbinHeader::MAGIC, sizeof(header.magic));
+	header.version = LobbinHeader::VERSION;
+	header.record_size = sizeof(Command);
+	header.count = commands.size();
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(commands.data()), static_cast<std::streamsize>(commands.size_bytes()));
+	return file.good();
+}
+
+bool LobbinFile::open(const std::string& path) {
+	commands = {};
+	if (not file.open(path))
+		return false;
+	std::string_view view = file.get_view();
+	if (view.size() < sizeof(LobbinHeader))
+		return false;
+	LobbinHeader header;
+	std::memcpy(&header, view.data(), sizeof(header));
+	if (std::memcmp(header.magic, LobbinHeader::MAGIC, sizeof(header.magic)) != 0 or header.version != LobbinHeader::VERSION
+			or header.record_size != sizeof(Command) or (view.size() - sizeof(header)) % sizeof(Command) != 0
+			or (view.size() - sizeof(header)) / sizeof(Command) != header.count)
+		return false;
+	commands = {reinterpret_cast<const Command*>(view.data() + sizeof(header)), header.count};
+	return true;
+}
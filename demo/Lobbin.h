@@ -0,0 +1,72 @@
+#ifndef ORDERBOOK_LOBBIN_H
+#define ORDERBOOK_LOBBIN_H
+
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <string>
+#include "Command.h"
+#include "OperationReader.h"
+
+/**
+ * .lobbin: fixed-width, little-endian binary order flow.
+ * A 32-byte LobbinHeader is followed by `count` records of 32 bytes, each one being a Command as laid out in memory:
+ *
+ *   offset  size  field
+ *        0     8  id
+ *        8     8  agent_id
+ *       16     8  volume
+ *       24     4  price
+ *       28     1  type (0 PLACE, 1 CANCEL, 2 AMEND)
+ *       29     1  side (0 BUY, 1 SELL)
+ *       30     2  symbol (0 for a single instrument)
+ *
+ * The records are therefore used in place once the file is mapped, without any decoding.
+ */
+static_assert(std::endian::native == std::endian::little, "Records are read in place, which needs a little-endian host");
+static_assert(offsetof(Command, agent_id) == 8 and offsetof(Command, volume) == 16 and offsetof(Command, price) == 24
+		and offsetof(Command, type) == 28 and offsetof(Command, side) == 29 and offsetof(Command, symbol) == 30,
+		"Command is the .lobbin record layout");
+
+struct LobbinHeader {
+	static constexpr char MAGIC[8] = {'L', 'O', 'B', 'B', 'I', 'N', '\0', '\0'};
+	static constexpr std::uint32_t VERSION = 1;
+
+	char magic[8]; /**< MAGIC */
+	std::uint32_t version; /**< VERSION */
+	std::uint32_t record_size; /**< sizeof(Command) */
+	std::uint64_t count; /**< Number of records following the header */
+	std::uint64_t reserved; /**< 0, pads the header so that the records stay 32-byte aligned in the mapping */
+};
+
+static_assert(sizeof(LobbinHeader) == 32);
+
+/**
+ * @brief Writes commands to a .lobbin file
+ * @param path path of the file, replaced if it exists
+ * @param commands commands to write
+ * @return false if the file could not be written
+ */
+bool write_lobbin(const std::string& path, std::span<const Command> commands);
+
+/** Mapped .lobbin file whose records are handed out in place */
+class LobbinFile {
+private:
+	MappedFile file; /**< Whole file, header included */
+	std::span<const Command> commands; /**< Records of the file */
+
+public:
+	LobbinFile() = default;
+
+	/**
+	 * @brief Maps a .lobbin file and checks its header
+	 * @param path path of the file
+	 * @return false if the file could not be opened or is not a valid .lobbin file of this version
+	 */
+	bool open(const std::string& path);
+
+	/** Getters */
+	std::span<const Command> get_commands() const { return commands; }
+};
+
+#endif //ORDERBOOK_LOBBIN_H
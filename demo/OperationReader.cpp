@@ -0,0 +1,176 @@
+#include "OperationReader.h"
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ORDERBOOK_HAS_MMAP 1
+#endif
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+void MappedFile::close() {
+#ifdef ORDERBOOK_HAS_MMAP
+	if (mapped)
+		munmap(const_cast<char*>(data), size);
+#endif
+	data = nullptr;
+	size = 0;
+	buffer.clear();
+	mapped = false;
+}
+
+bool MappedFile::open(const std::string& path) {
+	close();
+#ifdef ORDERBOOK_HAS_MMAP
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat info {};
+	if (fstat(fd, &info) != 0) {
+		::close(fd);
+		return false;
+	}
+	if (info.st_size > 0) {
+		void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (address != MAP_FAILED) {
+			madvise(address, info.st_size, MADV_SEQUENTIAL); // Read once front to back: let the kernel read ahead
+			data = static_cast<const char*>(address);
+			size = info.st_size;
+			mapped = true;
+		}
+	}
+	::close(fd);
+	if (mapped or info.st_size == 0)
+		return true;
+#endif
+	// No mapping available: read the whole file instead
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+		return false;
+	buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	data = buffer.data();
+	size = buffer.size();
+	return true;
+}
+
+namespace {
+
+constexpr std::size_t BLOCK = 64; /**< Bytes scanned at once, one bit per byte in the separator mask */
+
+/**
+ * @brief Finds the field and line separators of a block
+ * @param block BLOCK readable bytes
+ * @return mask whose bit i is set if block[i] is ',' or '\n'
+ */
+inline std::uint64_t separator_mask(const char* block) {
+#ifdef __AVX2__
+	const __m256i comma = _mm256_set1_epi8(',');
+	const __m256i newline = _mm256_set1_epi8('\n');
+	__m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+	__m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+	std::uint32_t low_mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(low, comma), _mm256_cmpeq_epi8(low, newline)));
+	std::uint32_t high_mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(high, comma), _mm256_cmpeq_epi8(high, newline)));
+	return low_mask | std::uint64_t(high_mask) << 32;
+#else
+	std::uint64_t mask = 0;
+	for (std::size_t i = 0; i < BLOCK; i++)
+		mask |= std::uint64_t(block[i] == ',' or block[i] == '\n') << i;
+	return mask;
+#endif
+}
+
+/**
+ * @brief Decodes the leading digits of a field (stops at the first other character, e.g. a trailing '\r')
+ * @return the value, 0 for an empty field
+ */
+inline std::uint64_t parse_number(const char* begin, const char* end) {
+	std::uint64_t value = 0;
+	for (; begin != end; begin++) {
+		unsigned digit = static_cast<unsigned char>(*begin) - '0';
+		if (digit > 9)
+			break;
+		value = value * 10 + digit;
+	}
+	return value;
+}
+
+/** Assembles the commands field by field as the separators are found */
+class CommandBuilder {
+private:
+	Commands& commands;
+	Command command{}; /**< Command of the current line */
+	unsigned field = 0; /**< Position of the next field in the line */
+	bool valid = false; /**< If the operation of the current line is known */
+
+public:
+	explicit CommandBuilder(Commands& commands): commands(commands) {}
+
+	void end_field(const char* begin, const char* end) {
+		switch (field++) {
+			case 0:
+				valid = begin != end and (*begin == 'P' or *begin == 'D' or *begin == 'A');
+				command.type = begin == end or *begin == 'P' ? PLACE : *begin == 'D' ? CANCEL : AMEND;
+				break;
+			case 1: command.id = parse_number(begin, end); break;
+			case 2: if (command.type != CANCEL) command.side = parse_number(begin, end) == BUY ? BUY : SELL; break;
+			case 3: command.price = static_cast<Price>(parse_number(begin, end)); break;
+			case 4: command.volume = parse_number(begin, end); break;
+			default: break;
+		}
+	}
+	void end_line() {
+		if (valid and field > 1)
+			commands.push_back(command);
+		command = Command{};
+		field = 0;
+		valid = false;
+	}
+	bool in_line() const { return field != 0; }
+};
+
+} // namespace
+
+std::size_t parse_operations(std::string_view text, Commands& commands) {
+	std::size_t header_end = text.find('\n');
+	if (header_end == std::string_view::npos)
+		return 0;
+	const std::size_t nb_before = commands.size();
+	commands.reserve(nb_before + text.size() / 16); // Operation lines are rarely shorter than 16 bytes: no regrowth in practice
+
+	const char* base = text.data();
+	const std::size_t size = text.size();
+	CommandBuilder builder(commands);
+	std::size_t field_start = header_end + 1;
+	for (std::size_t block = field_start; block < size; block += BLOCK) {
+		std::uint64_t mask;
+		if (size - block >= BLOCK) {
+			mask = separator_mask(base + block);
+		} else {
+			char tail[BLOCK] = {}; // Zero padding holds no separator
+			std::memcpy(tail, base + block, size - block);
+			mask = separator_mask(tail);
+		}
+		while (mask) {
+			std::size_t at = block + std::countr_zero(mask);
+			mask &= mask - 1;
+			builder.end_field(base + field_start, base + at);
+			if (base[at] == '\n')
+				builder.end_line();
+			field_start = at + 1;
+		}
+	}
+	// Last line without a line break
+	if (field_start < size or builder.in_line()) {
+		builder.end_field(base + field_start, base + size);
+		builder.end_line();
+	}
+	return commands.size() - nb_before;
+}
@@ -0,0 +1,52 @@
+#ifndef ORDERBOOK_OPERATIONREADER_H
+#define ORDERBOOK_OPERATIONREADER_H
+
+#include <string>
+#include <string_view>
+#include "Command.h"
+
+/**
+ * Read-only view of a whole file. It is memory mapped where the platform allows it (pages are read on first
+ * access, without copying), and read into a buffer otherwise.
+ */
+class MappedFile {
+private:
+	const char* data; /**< First byte of the file */
+	std::size_t size; /**< Number of bytes */
+	std::string buffer; /**< Contents of the file when it could not be mapped */
+	bool mapped; /**< If data points to a mapping that must be released */
+
+	void close();
+
+public:
+	MappedFile(): data(nullptr), size(0), buffer(), mapped(false) {}
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile() { close(); }
+
+	/**
+	 * @brief Maps a file, releasing the previously opened one
+	 * @param path path of the file
+	 * @return false if the file could not be opened
+	 */
+	bool open(const std::string& path);
+
+	/** Getters */
+	std::string_view get_view() const { return {data, size}; }
+	std::size_t get_size() const { return size; }
+};
+
+/**
+ * @brief Decodes an operations CSV as written by demo/generate_orders*.py into commands
+ * The first line is a header, then every line is either `PLACE,id,type,price,volume` (type 0 for BUY, 1 for SELL)
+ * or `DELETE,id,,,` (`AMEND,id,type,price,volume` is also accepted). Lines may end with "\n" or "\r\n", lines with an
+ * unknown operation are skipped.
+ * Field and line separators are located 64 bytes at a time (AVX2 when the build targets it, a scalar loop otherwise)
+ * and numbers are decoded as 64-bit values in place, without building any intermediate string.
+ * @param text contents of the file
+ * @param commands array the commands are appended to
+ * @return number of commands appended
+ */
+std::size_t parse_operations(std::string_view text, Commands& commands);
+
+#endif //ORDERBOOK_OPERATIONREADER_H
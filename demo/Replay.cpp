@@ -0,0 +1,120 @@
+#include "Replay.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+namespace {
+
+/** Capacity of the L2 feed ring, drained after every command or window */
+constexpr std::size_t FEED_CAPACITY = 1 << 16;
+
+/**
+ * @brief Replay loop timing every command, one call to the book per command
+ */
+ReplayStats replay_timed(Book& book, std::span<const Command> commands, LatencyRecorder* latency, LevelRing* feed, LevelBook* l2,
+		Journal* journal) {
+	ReplayStats stats;
+	// 成交本身不保存; 统计本次撮合跨越的价格档位数, 用于区分单档撮合与多档扫单
+	Price last_price = 0;
+	Length levels = 0;
+	auto on_trade = [&last_price, &levels](const Trade& trade) {
+		levels += trade.get_price() != last_price;
+		last_price = trade.get_price();
+	};
+	auto place_kind = [&levels](const PlaceResult& result) {
+		return result.fills == 0 ? RESTING_INSERT : levels > 1 ? MULTI_LEVEL_SWEEP : AGGRESSIVE_MATCH;
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	for (const Command& command : commands) {
+		last_price = 0;
+		levels = 0;
+		std::uint64_t command_start = TscClock::now();
+		// 先写日志再执行, 写日志只是拷贝进缓冲区, 计入命令延迟
+		if (journal)
+			journal->append(command);
+		LatencyKind kind;
+		switch (command.type) {
+			case PLACE: {
+				// 每笔交易算一次操作；如果订单挂在订单簿上，也算一次操作
+				PlaceResult result = book.place_order(command.id, command.agent_id, command.side, command.price, command.volume, on_trade);
+				stats.nb_op += result.fills + result.is_resting();
+				stats.placed++;
+				kind = place_kind(result);
+				break;
+			}
+			case CANCEL:
+				book.delete_order(command.id);
+				stats.nb_op++;
+				stats.cancelled++;
+				kind = CANCEL_ORDER;
+				break;
+			case AMEND: {
+				// 改单算一次操作, 改价后产生的每笔交易也各算一次; 方向与 agent 沿用原订单
+				PlaceResult result = book.amend_order(command.id, command.price, command.volume, on_trade);
+				stats.nb_op += 1 + result.fills;
+				stats.amended++;
+				kind = AMEND_ORDER;
+				break;
+			}
+			default:
+				continue;
+		}
+		latency->record(kind, TscClock::now() - command_start);
+		// 行情消费不计入单条命令的延迟
+		if (l2)
+			stats.level_updates += l2->drain(*feed);
+	}
+	stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return stats;
+}
+
+/**
+ * @brief Untimed replay loop, feeding the book windows of BATCH_SIZE commands (see Book::process_batch)
+ */
+ReplayStats replay_batched(Book& book, std::span<const Command> commands, LevelRing* feed, LevelBook* l2, Journal* journal) {
+	constexpr std::size_t BATCH_SIZE = 64;
+	ReplayStats stats;
+	PlaceResult results[BATCH_SIZE];
+	auto start = std::chrono::steady_clock::now();
+	for (std::size_t first = 0; first < commands.size(); first += BATCH_SIZE) {
+		std::span<const Command> batch = commands.subspan(first, std::min(BATCH_SIZE, commands.size() - first));
+		if (journal)
+			journal->append(batch);
+		book.process_batch(batch, [](const Trade&) {}, results);
+		if (l2)
+			stats.level_updates += l2->drain(*feed);
+		// 操作数的算法与逐条回放相同
+		for (std::size_t i = 0; i < batch.size(); i++) {
+			switch (batch[i].type) {
+				case PLACE:
+					stats.nb_op += results[i].fills + results[i].is_resting();
+					stats.placed++;
+					break;
+				case CANCEL:
+					stats.nb_op++;
+					stats.cancelled++;
+					break;
+				case AMEND:
+					stats.nb_op += 1 + results[i].fills;
+					stats.amended++;
+					break;
+				default:
+					break;
+			}
+		}
+	}
+	stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return stats;
+}
+
+} // namespace
+
+ReplayStats replay_commands(Book& book, std::span<const Command> commands, LatencyRecorder* latency, LevelBook* l2, Journal* journal) {
+	std::unique_ptr<LevelRing> feed = l2 ? std::make_unique<LevelRing>(FEED_CAPACITY) : nullptr;
+	book.set_level_feed(feed.get());
+	ReplayStats stats = latency ? replay_timed(book, commands, latency, feed.get(), l2, journal)
+			: replay_batched(book, commands, feed.get(), l2, journal);
+	book.set_level_feed(nullptr);
+	return stats;
+}
@@ -0,0 +1,38 @@
+#ifndef ORDERBOOK_REPLAY_H
+#define ORDERBOOK_REPLAY_H
+
+#include <span>
+#include "Book.h"
+#include "Command.h"
+#include "Journal.h"
+#include "Latency.h"
+
+/** Counters of a replay */
+struct ReplayStats {
+	std::uint64_t nb_op = 0; /**< Operations done by the book: one per trade, per resting order and per cancel */
+	Length placed = 0; /**< Number of PLACE commands */
+	Length cancelled = 0; /**< Number of CANCEL commands */
+	Length amended = 0; /**< Number of AMEND commands */
+	Length level_updates = 0; /**< L2 updates consumed, when the feed is on */
+	double seconds = 0; /**< Wall-clock time spent in the book */
+};
+
+/**
+ * @brief Feeds commands to a book in order, trades are dropped
+ * Without latency, the commands go through Book::process_batch in windows of 64.
+ * AMEND goes through Book::amend_order: the side and agent of the command are ignored, amends of orders that are no
+ * longer resting are refused by the book.
+ * @param book book the commands are applied to
+ * @param commands commands to apply
+ * @param latency if not null, every command is timed with the TSC and recorded by kind: place orders that rest without
+ * trading, that trade at one price level or that sweep several levels, cancels and amends (costs two clock reads each)
+ * @param l2 if not null, the L2 feed of the book is on during the replay and applied to l2 after every window (or
+ * every command when timed); the book must be empty
+ * @param journal if not null, every window (or command when timed) is appended to this started journal before the book
+ * executes it, the replay never waits for the journal to be written
+ * @return counters of the replay
+ */
+ReplayStats replay_commands(Book& book, std::span<const Command> commands, LatencyRecorder* latency = nullptr, LevelBook* l2 = nullptr,
+		Journal* journal = nullptr);
+
+#endif //ORDERBOOK_REPLAY_H
@@ -1,48 +1,9 @@
 #include <iostream>
 #include <fstream>
-// #include <sstream>
-#include<charconv>
 #include <chrono>
 #include "Book.h"
-
-// std::vector<std::string> split(const std::string &line, char delimiter) {
-// 	std::vector<std::string> tokens;
-// 	std::string token;
-// 	std::istringstream tokenStream(line);
-// 	while (std::getline(tokenStream, token, delimiter)) {
-// 		tokens.push_back(token);
-// 	}
-// 	return tokens;
-// }
-
-// template<typename T>
-// T sv_to_num(std::string_view sv) {
-//     T value = 0;
-//     std::from_chars(sv.data(), sv.data() + sv.size(), value);
-//     return value;
-// }
-
-int sv_to_num(std::string_view sv) {
-    int value = 0;
-    std::from_chars(sv.data(), sv.data() + sv.size(), value);
-    return value;
-}
-
-void split(std::string_view line, char delimiter, std::vector<std::string_view>& out_tokens){
-	out_tokens.clear();
-
-	size_t start = 0;
-	size_t end = 0;
-
-	while ((end = line.find(delimiter, start)) != std::string_view::npos){
-		out_tokens.emplace_back(line.substr(start, end - start));
-		start = end + 1;
-	}
-
-	if (start < line.size()){
-		out_tokens.emplace_back(line.substr(start));
-	}
-}
+#include "OperationReader.h"
+#include "Replay.h"
 
 void write_final_order_book(Book& book) {
 	std::ofstream file("../demo/final_order_book.csv");
@@ -51,78 +12,41 @@ void write_final_order_book(Book& book) {
 		return;
 	}
 	file << "Price Limit,Side,Volume\n";
-	for (auto& limit: book.get_buy_limits())
-		file << limit.first << ",BUY,"<< limit.second->get_total_volume() << "\n";
-	for (auto& limit: book.get_sell_limits())
-		file << limit.first << ",SELL,"<< limit.second->get_total_volume() << "\n";
+	// 按价格升序输出 (哈希表的遍历顺序不固定, 且阶梯模式下部分价位不在哈希表中)
+	for (LimitPointer limit : book.get_levels(BUY))
+		file << limit->get_price() << ",BUY,"<< limit->get_total_volume() << "\n";
+	for (LimitPointer limit : book.get_levels(SELL))
+		file << limit->get_price() << ",SELL,"<< limit->get_total_volume() << "\n";
 	file.close();
 }
 
 void demo() {
-	// 打开操作指令CSV文件
+	// 映射操作指令CSV文件 (不拷贝, 按需读入页面)
 	// std::string exe_path = std::filesystem::current_path().string();
 	// std::string file_path = exe_path + "/demo/sample_operations.csv";
-	std::ifstream file("../demo/sample_operations.csv");
-	if (!file.is_open()) {
+	MappedFile file;
+	if (!file.open("../demo/sample_operations.csv")) {
 		std::cerr << "Error opening file.\n";
 		return;
 	}
 
-	// 创建订单簿对象
-	Book book;
-	// 操作计数器，用于统计性能
-	std::uint64_t nb_op = 0;
-	// 用于性能计时的时间点变量
+	// 先把整个文件解析为预分配的指令数组, 解析与撮合分开计时, 吞吐量只统计订单簿本身
 	std::chrono::time_point<std::chrono::system_clock> start, end;
-
-	// 读取并跳过CSV文件的标题行
-	std::string line;
-	std::getline(file, line);
-
-	// 开始计时
 	start = std::chrono::system_clock::now();
-	while (std::getline(file, line)) {
-		// 按逗号分割每行数据
-		std::vector<std::string_view> fields;
-		fields.reserve(5);
-		split(line, ',', fields);
-
-		if (fields[0] == "PLACE") {
-			// 创建新订单。参数依次为：订单ID, agent_id(这里设为0), 买卖方向(BUY/SELL), 价格, 数量
-			// OrderPointer是std::shared_ptr<Order>的类型别名，用于智能管理Order对象的内存
-			// OrderPointer order(new Order(stoi(fields[1]), 0, stoi(fields[2]) == BUY ? BUY : SELL, stoi(fields[3]), stoi(fields[4])));
-			// OrderPointer order(new Order (sv_to_num(fields[1]),0 ,sv_to_num(fields[2]) == BUY ? BUY : SELL, sv_to_num(fields[3]), sv_to_num(fields[4])));
-			// 将订单放入订单簿，返回产生的交易列表
-			// Trades是std::vector<Trade>的类型别名，记录了所有因此订单而产生的成交
-			// Trades trades = book.place_order(order);
-			// 统计操作数：每笔交易算一次操作；如果订单状态为ACTIVE，表示它被插入了订单簿，也算一次操作
-
-			ID id = sv_to_num(fields[1]);
-			OrderType type = (sv_to_num(fields[2]) == BUY) ? BUY : SELL;
-			Price price = sv_to_num(fields[3]);
-			Volume volume = sv_to_num(fields[4]);
-
-			Trades trades = book.place_order(id, 0, type, price, volume);
-
-			nb_op += trades.size();
-			if (book.get_order_status(id) == ACTIVE) nb_op++;
-			 // + (order->get_status() == ACTIVE); // each trade is an operation; if the order is active it has been inserted otherwise no operation
-		} else {
-			book.delete_order(sv_to_num(fields[1]));
-			nb_op++;
-		}
-	}
-	// 结束计时
+	Commands commands;
+	parse_operations(file.get_view(), commands);
 	end = std::chrono::system_clock::now();
-	// 计算执行时间（秒）
-	std::chrono::duration<double> elapsed_seconds = end - start;
+	std::chrono::duration<double> parse_seconds = end - start;
 
-	// 输出性能统计信息
-	std::cout << "Elapsed time: " << elapsed_seconds.count() << "s" << std::endl;
-	std::cout << "Operations per second: " << (double)nb_op / elapsed_seconds.count() << std::endl;
+	// 创建订单簿对象, 按顺序回放所有指令
+	Book book;
+	ReplayStats stats = replay_commands(book, commands);
 
-	// 关闭文件
-	file.close();
+	// 输出性能统计信息
+	std::cout << "Parsed " << commands.size() << " commands in " << parse_seconds.count() << "s ("
+			<< file.get_size() / parse_seconds.count() / 1e6 << " MB/s)" << std::endl;
+	std::cout << "Elapsed time: " << stats.seconds << "s" << std::endl;
+	std::cout << "Operations per second: " << (double)stats.nb_op / stats.seconds << std::endl;
 
 	// 将最终订单簿状态写入文件
 	write_final_order_book(book);
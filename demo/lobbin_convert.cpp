@@ -0,0 +1,24 @@
+#include <iostream>
+#include "Lobbin.h"
+
+// Converts an operations CSV (demo/generate_orders*.py) to the .lobbin binary format
+// Usage: lobbin_convert <operations.csv> <operations.lobbin>
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		std::cerr << "Usage: " << argv[0] << " <operations.csv> <operations.lobbin>\n";
+		return 1;
+	}
+	MappedFile csv;
+	if (!csv.open(argv[1])) {
+		std::cerr << "Error opening " << argv[1] << ".\n";
+		return 1;
+	}
+	Commands commands;
+	parse_operations(csv.get_view(), commands);
+	if (!write_lobbin(argv[2], commands)) {
+		std::cerr << "Error writing " << argv[2] << ".\n";
+		return 1;
+	}
+	std::cout << "Converted " << commands.size() << " commands to " << argv[2] << std::endl;
+	return 0;
+}
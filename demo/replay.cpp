@@ -0,0 +1,158 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include "Lobbin.h"
+#include "Replay.h"
+
+// Replays an order flow into a default book and reports the throughput of the book alone
+// Usage: OrderBook_replay <operations.lobbin | operations.csv> [--latency] [--latency-json <summary.json>] [--l2-feed]
+//                         [--load-snapshot <book.snapshot>] [--save-snapshot <book.snapshot>] [--journal <commands.journal>]
+// .lobbin files are mapped and their records fed to the book in place, CSV files are parsed first.
+// --latency times every operation and prints its percentiles per kind, --latency-json also writes them as JSON.
+// --l2-feed keeps the L2 feed of the book on, rebuilds the levels from it and checks them against the book.
+// --load-snapshot starts from a saved book instead of an empty one, --save-snapshot saves the book after the replay.
+// --journal writes every command to a new journal before executing it (group commit with fdatasync on a background
+// thread), OrderBook_journal_replay rebuilds the book from it.
+int main(int argc, char** argv) {
+	const char* usage = " <operations.lobbin | operations.csv> [--latency] [--latency-json <summary.json>] [--l2-feed]\n"
+			"    [--load-snapshot <book.snapshot>] [--save-snapshot <book.snapshot>] [--journal <commands.journal>]\n";
+	if (argc < 2) {
+		std::cerr << "Usage: " << argv[0] << usage;
+		return 1;
+	}
+	std::string path = argv[1];
+	bool timed = false;
+	std::string json_path;
+	bool l2_feed = false;
+	std::string load_path;
+	std::string save_path;
+	std::string journal_path;
+	for (int i = 2; i < argc; i++) {
+		std::string option = argv[i];
+		if (option == "--latency") {
+			timed = true;
+		} else if (option == "--latency-json" and i + 1 < argc) {
+			timed = true;
+			json_path = argv[++i];
+		} else if (option == "--l2-feed") {
+			l2_feed = true;
+		} else if (option == "--load-snapshot" and i + 1 < argc) {
+			load_path = argv[++i];
+		} else if (option == "--save-snapshot" and i + 1 < argc) {
+			save_path = argv[++i];
+		} else if (option == "--journal" and i + 1 < argc) {
+			journal_path = argv[++i];
+		} else {
+			std::cerr << "Usage: " << argv[0] << usage;
+			return 1;
+		}
+	}
+	if (l2_feed and not load_path.empty()) {
+		std::cerr << "--l2-feed rebuilds the levels from an empty book, it cannot be used with --load-snapshot.\n";
+		return 1;
+	}
+	if (not journal_path.empty() and not load_path.empty()) {
+		std::cerr << "--journal records the commands of an empty book, it cannot be used with --load-snapshot.\n";
+		return 1;
+	}
+	LobbinFile lobbin;
+	Commands parsed;
+	std::span<const Command> commands;
+	if (path.ends_with(".lobbin")) {
+		if (!lobbin.open(path)) {
+			std::cerr << "Error opening " << path << " (missing file or not a .lobbin file).\n";
+			return 1;
+		}
+		commands = lobbin.get_commands();
+	} else {
+		MappedFile csv;
+		if (!csv.open(path)) {
+			std::cerr << "Error opening " << path << ".\n";
+			return 1;
+		}
+		parse_operations(csv.get_view(), parsed);
+		commands = parsed;
+	}
+
+	Book book;
+	if (not load_path.empty()) {
+		auto start = std::chrono::steady_clock::now();
+		if (not book.load_snapshot(load_path)) {
+			std::cerr << "Error loading " << load_path << " (missing file or not a snapshot of this version).\n";
+			return 1;
+		}
+		std::cout << "Snapshot loaded: " << book.get_id_to_order().size() << " orders in "
+				<< std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << "s" << std::endl;
+	}
+	std::unique_ptr<LatencyRecorder> latency = timed ? std::make_unique<LatencyRecorder>() : nullptr; // Calibrates the clock
+	std::unique_ptr<LevelBook> l2 = l2_feed ? std::make_unique<LevelBook>() : nullptr;
+	std::unique_ptr<Journal> journal = journal_path.empty() ? nullptr : std::make_unique<Journal>();
+	if (journal) {
+		// 日志只能从空订单簿开始记录, 不往已有的日志后面追加
+		if (not journal->open(journal_path) or journal->get_durable() != 0) {
+			std::cerr << "Error opening " << journal_path << " (not writable, or an existing journal).\n";
+			return 1;
+		}
+		journal->start();
+	}
+	ReplayStats stats = replay_commands(book, commands, latency.get(), l2.get(), journal.get());
+	if (journal) {
+		journal->stop();
+		if (journal->has_failed()) {
+			std::cerr << "Error writing " << journal_path << ".\n";
+			return 1;
+		}
+	}
+
+	std::cout << "Commands: " << commands.size() << " (" << stats.placed << " place, " << stats.cancelled << " cancel, "
+			<< stats.amended << " amend)" << std::endl;
+	std::cout << "Elapsed time: " << stats.seconds << "s" << std::endl;
+	std::cout << "Operations per second: " << (double)stats.nb_op / stats.seconds << std::endl;
+	std::cout << "Resting orders: " << book.get_id_to_order().size() << ", best bid: " << book.get_best_buy()
+			<< ", best ask: " << book.get_best_sell() << std::endl;
+	if (journal)
+		std::cout << "Journal: " << journal->get_durable() << " commands in " << journal->get_commits() << " group commits" << std::endl;
+	if (l2) {
+		// 由行情重建的价位应与订单簿完全一致
+		bool same = true;
+		for (OrderType side : {BUY, SELL}) {
+			std::vector<LimitPointer> levels = book.get_levels(side);
+			std::vector<DepthLevel> rebuilt = l2->get_levels(side);
+			same = same and levels.size() == rebuilt.size();
+			for (std::size_t i = 0; same and i < levels.size(); i++) {
+				LimitPointer limit = levels[side == BUY ? levels.size() - 1 - i : i];
+				same = rebuilt[i] == DepthLevel{limit->get_price(), limit->get_total_volume(), limit->get_length()};
+			}
+		}
+		std::cout << "L2 updates: " << stats.level_updates << ", gaps: " << l2->get_gaps()
+				<< ", rebuilt levels " << (same ? "match" : "DIFFER from") << " the book" << std::endl;
+	}
+	if (STATS_ENABLED) {
+		BookStats book_stats = book.get_stats();
+		std::cout << "Levels created: " << book_stats.levels_created << ", destroyed: " << book_stats.levels_destroyed
+				<< ", best price recomputations: " << book_stats.best_recomputations << "\n"
+				<< "Id map lookups: " << book_stats.id_lookups << ", rehashes: " << book_stats.id_rehashes
+				<< ", buckets: " << book_stats.id_buckets << "\n"
+				<< "Match calls: " << book_stats.match_calls << ", orders walked: " << book_stats.orders_walked
+				<< ", tombstones skipped: " << book_stats.tombstones_skipped << ", compactions: " << book_stats.queue_compactions << "\n"
+				<< "Rejects: " << book_stats.duplicate_rejects << " duplicate id, " << book_stats.invalid_price_rejects << " invalid price\n"
+				<< "Pool slabs: " << book_stats.order_slabs << " order, " << book_stats.limit_slabs << " limit" << std::endl;
+	}
+	if (not save_path.empty() and not book.save_snapshot(save_path)) {
+		std::cerr << "Error writing " << save_path << ".\n";
+		return 1;
+	}
+	if (latency) {
+		latency->print(std::cout);
+		if (not json_path.empty()) {
+			std::ofstream json(json_path);
+			if (!json.is_open()) {
+				std::cerr << "Error writing " << json_path << ".\n";
+				return 1;
+			}
+			latency->write_json(json);
+		}
+	}
+	return 0;
+}
@@ -1,5 +1,35 @@
 #include "Book.h"
 #include<iostream>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+Book::Book(const BookConfig& config):
+		config(config), buy_tree(), buy_limits(), sell_tree(), sell_limits(),
+		buy_depth(BUY, config.depth_levels), sell_depth(SELL, config.depth_levels), level_feed(nullptr), level_sequence(0),
+		order_feed(nullptr), order_sequence(0),
+		best_buy(0), best_sell(0),
+		order_pool(config.order_slab_size, config.prefault_pools), limit_pool(config.limit_slab_size, config.prefault_pools) {
+	order_pool.reserve(config.reserved_orders);
+	if (config.queue_levels)
+		spare_queues.reserve(MAX_SPARE_QUEUES);
+	if (config.use_ladder and config.band_levels > 0) {
+		buy_ladder = PriceLadder(config.band_base, config.tick_size, config.band_levels);
+		sell_ladder = PriceLadder(config.band_base, config.tick_size, config.band_levels);
+	}
+	if (config.use_bitmap and config.band_levels > 0) {
+		buy_bitmap = PriceBitmap(config.band_base, config.tick_size, config.band_levels);
+		sell_bitmap = PriceBitmap(config.band_base, config.tick_size, config.band_levels);
+	}
+}
+
+Book::~Book() {
+	// The limit pool does not track live objects: destroy what is still in the book (orders are freed with their pool)
+	for (OrderType type : {BUY, SELL})
+		for (LimitPointer limit : get_levels(type))
+			limit_pool.destroy(limit);
+}
 
 // Trades Book::place_order(OrderPointer& order) {
 // 	if (order->get_price() <= 0)
@@ -28,271 +58,768 @@
 // }
 
 Trades Book::place_order(ID id, ID agent_id, OrderType type, Price price, Volume volume) {
-	// --- 使用内存池创建 Order 对象 (使用 construct 获取裸指针) ---
+	Trades trades;
+	place_order(id, agent_id, type, price, volume, trades);
+	return trades;
+}
+
+PlaceResult Book::place_order(ID id, ID agent_id, OrderType type, Price price, Volume volume, Trades& trades) {
+	return place_order(id, agent_id, type, price, volume, [&trades](const Trade& trade) { trades.push_back(trade); });
+}
+
+PlaceResult Book::place_order(ID id, ID agent_id, OrderType type, Price price, Volume volume, TradeSink sink) {
 	// 价格检查
-    if (price <= 0)
-		return {};
+    if (price <= 0) {
+		ORDERBOOK_STAT(stats.invalid_price_rejects++;)
+		return PlaceResult::rejected(INVALID_PRICE);
+	}
 
     // --- 使用内存池创建 Order 对象 ---
     // 1. 检查是否已存在相同 ID 的订单 (可选但推荐)
+    ORDERBOOK_STAT(stats.id_lookups++;)
     if (id_to_order.count(id)) {
          // 处理重复订单 ID 的情况，例如返回错误或忽略
+         ORDERBOOK_STAT(stats.duplicate_rejects++;)
          std::cerr << "Warning: Order ID " << id << " already exists." << std::endl;
-         return {};
+         return PlaceResult::rejected(DUPLICATE_ID);
     }
 
-	// 2. 使用 order_pool.malloc + placement new 分配和构造 Order 对象
-	Order* order = static_cast<Order*>(order_pool.malloc());
-	if (!order) {
-		// 处理内存分配失败
-		throw std::bad_alloc();
-	}
-	try {
-		// 使用 placement new 在分配的内存上构造对象
-		new(order) Order(id, agent_id, type, price, volume);
-	} catch (...) {
-		// 如果构造失败，释放内存并重新抛出异常
-		order_pool.free(order);
-		throw;
-	}
-	// No shared_ptr or custom deleter needed anymore
+	// 2. 从内存池分配并构造 Order 对象 (O(1), 分配失败时抛出 std::bad_alloc), 冷数据存放在同一槽位的伴随记录中
+	OrderIndex index = order_pool.construct(id, type, price, volume);
+	order_pool.cold(index) = {agent_id, volume};
 	   // --- End Order 对象创建 ---
 
+	// 方向只在这里判断一次, 之后的撮合循环按方向在编译期特化
+	PlaceResult result = type == BUY ? match_and_rest<BUY>(index, sink) : match_and_rest<SELL>(index, sink);
+	publish_level_updates();
+	return result;
+}
 
-    // --- 接下来的逻辑与之前类似，但使用新创建的 'order' ---
-	Trades trades;
-	// id_to_order[order->get_id()] = order; // Moved to later, only if order rests
-
-	if (order->get_type() == BUY) {
-		// 注意：这里 price 来自参数，不再是 order->get_price()，因为 order 是新创建的
-        // 但逻辑上应该是一样的，使用 order->get_price() 也没问题
-		while (best_sell != 0 && order->get_price() >= best_sell && order->get_status() != FULFILLED) {
-			// get_or_create_limit 内部已修改为使用 pool
-			Limit* sell_limit = get_or_create_limit(best_sell, false); // 获取 Limit* 指针
-            if (!sell_limit) continue; // 防御性编程
-
-			Trades trades_at_limit = sell_limit->match_order(order); // 使用 Limit* 对象
-			trades.insert(trades.end(), trades_at_limit.begin(), trades_at_limit.end());
-
-			// --- 销毁在此 Limit 被完全撮合的订单 ---
-			for (const auto& trade : trades_at_limit) {
-				ID matched_id = trade.get_matched_order();
-				auto it = id_to_order.find(matched_id);
-				if (it != id_to_order.end()) {
-					Order* matched_order_ptr = it->second;
-					if (matched_order_ptr->get_status() == FULFILLED) {
-						id_to_order.erase(it); // 从 map 中移除
-						order_pool.destroy(matched_order_ptr); // 归还给内存池
-					}
-				}
-			}
-			// --- End 销毁 ---
-
-			check_for_empty_sell_limit(best_sell); // 检查 Limit 是否变空 (内部会 destroy Limit)
-		}
-	} else { // SELL order
-		while (best_buy != 0 && order->get_price() <= best_buy && order->get_status() != FULFILLED) {
-            Limit* buy_limit = get_or_create_limit(best_buy, true); // 获取 Limit* 指针
-            if (!buy_limit) continue;
-
-			Trades trades_at_limit = buy_limit->match_order(order); // 使用 Limit* 对象
-			trades.insert(trades.end(), trades_at_limit.begin(), trades_at_limit.end());
-
-			// --- 销毁在此 Limit 被完全撮合的订单 ---
-			for (const auto& trade : trades_at_limit) {
-				ID matched_id = trade.get_matched_order();
-				auto it = id_to_order.find(matched_id);
-				if (it != id_to_order.end()) {
-					Order* matched_order_ptr = it->second;
-					if (matched_order_ptr->get_status() == FULFILLED) {
-						id_to_order.erase(it); // 从 map 中移除
-						order_pool.destroy(matched_order_ptr); // 归还给内存池
-					}
-				}
-			}
-			// --- End 销毁 ---
-
-			check_for_empty_buy_limit(best_buy); // 检查 Limit 是否变空 (内部会 destroy Limit)
-		}
+PlaceResult Book::place_order(ID id, ID agent_id, OrderType type, OrderKind kind, Price price, Volume volume, Trades& trades) {
+	return place_order(id, agent_id, type, kind, price, volume, [&trades](const Trade& trade) { trades.push_back(trade); });
+}
+
+PlaceResult Book::place_order(ID id, ID agent_id, OrderType type, OrderKind kind, Price price, Volume volume, TradeSink sink) {
+	if (kind == LIMIT)
+		return place_order(id, agent_id, type, price, volume, sink);
+	// 市价单不限价: 买单可吃到任意高的卖价, 卖单可吃到任意低的买价
+	if (kind == MARKET)
+		price = type == BUY ? std::numeric_limits<Price>::max() : 0;
+	else if (price <= 0) {
+		ORDERBOOK_STAT(stats.invalid_price_rejects++;)
+		return PlaceResult::rejected(INVALID_PRICE);
 	}
 
+	// 与限价单一样拒绝重复的订单号 (一次哈希查找, 不占内存池槽位), 否则可能和自己的挂单成交
+	ORDERBOOK_STAT(stats.id_lookups++;)
+	if (id_to_order.count(id)) {
+		ORDERBOOK_STAT(stats.duplicate_rejects++;)
+		return PlaceResult::rejected(DUPLICATE_ID);
+	}
+
+	// FOK 先按各档总量预检, 不够则直接拒绝, 不读任何挂单
+	if (kind == FOK and not (type == BUY ? can_fill<BUY>(price, volume) : can_fill<SELL>(price, volume))) {
+		ORDERBOOK_STAT(stats.fok_rejects++;)
+		return PlaceResult::rejected(NOT_FILLABLE);
+	}
+	PlaceResult result = type == BUY ? match_immediate<BUY>(id, price, volume, sink) : match_immediate<SELL>(id, price, volume, sink);
+	publish_level_updates();
+	return result;
+}
+
+template<OrderType S>
+Price Book::next_level(Price price) {
+	// Same sources as update_best: the band (bitmap, or ladder without bitmap) then the tree, the better one wins
+	Price next_tree = 0;
+	Price next_band = 0;
+	if constexpr (S == BUY) {
+		auto it = tree<S>().lower_bound(price);
+		next_tree = it == tree<S>().begin() ? 0 : *std::prev(it);
+		if (bitmap<S>().is_enabled())
+			next_band = bitmap<S>().find_highest_at_or_below(price - 1);
+		else if (ladder<S>().is_enabled())
+			next_band = ladder<S>().find_highest_at_or_below(price - 1);
+	} else {
+		auto it = tree<S>().upper_bound(price);
+		next_tree = it == tree<S>().end() ? 0 : *it;
+		if (price == std::numeric_limits<Price>::max())
+			next_band = 0;
+		else if (bitmap<S>().is_enabled())
+			next_band = bitmap<S>().find_lowest_at_or_above(price + 1);
+		else if (ladder<S>().is_enabled())
+			next_band = ladder<S>().find_lowest_at_or_above(price + 1);
+	}
+	return next_band and (not next_tree or is_better<S>(next_band, next_tree)) ? next_band : next_tree;
+}
+
+template<OrderType S>
+bool Book::can_fill(Price price, Volume volume) {
+	constexpr OrderType O = opposite(S);
+	Volume available = 0;
+	for (Price level = best<O>(); level != 0 and not is_better<S>(level, price); level = next_level<O>(level)) {
+		available += find_limit<O>(level)->get_total_volume();
+		if (available >= volume)
+			return true;
+	}
+	return false;
+}
+
+template<OrderType S>
+Length Book::match(Order* order, TradeSink sink) {
+	constexpr OrderType O = opposite(S);
+	Price& best_opposite = best<O>();
+	Length fills = 0;
+
+	// 成交数在转交给 sink 的同时累计, 调用方无需再次查询订单
+	auto on_trade = [this, &fills, sink](const Trade& trade) {
+		fills++;
+		if (order_feed)
+			publish_order_event(EXECUTE_ORDER, O, trade.get_matched_order(), trade.get_price(), trade.get_volume(), trade.get_incoming_order());
+		sink(trade);
+	};
+
+	// 成交直接交给 sink; 被完全撮合的挂单由 Limit 直接交回, 按其 ID 从 map 中移除后归还给内存池
+	auto on_filled = [this](OrderIndex matched_index) {
+		ORDERBOOK_STAT(stats.id_lookups++;)
+		id_to_order.erase(order_pool.at(matched_index)->get_id());
+		order_pool.destroy(matched_index); // Every handle to this order is now stale
+	};
+
+	// 对手方最优价不差于委托价时持续撮合
+	while (best_opposite != 0 && not is_better<S>(best_opposite, order->get_price()) && order->get_status() != FULFILLED) {
+		Limit* limit = find_limit<O>(best_opposite); // 获取 Limit* 指针
+		if (!limit) continue; // 防御性编程
+
+		limit->match_order(order, on_trade, on_filled); // 使用 Limit* 对象
+		level_changed<O>(limit);
+		check_for_empty_limit<O>(best_opposite); // 检查 Limit 是否变空 (内部会 destroy Limit)
+	}
+	return fills;
+}
+
+template<OrderType S>
+PlaceResult Book::match_immediate(ID id, Price price, Volume volume, TradeSink sink) {
+	// 订单只在栈上存在: 不占内存池槽位, 也不进入 id map
+	Order order(id, S, price, volume);
+	PlaceResult result;
+	result.fills = match<S>(&order, sink);
+	result.filled = volume - order.get_volume();
+	if (order.get_status() == FULFILLED) {
+		result.status = FULFILLED;
+		return result;
+	}
+	// 未成交部分直接丢弃
+	ORDERBOOK_STAT(stats.dropped_remainders++;)
+	return result;
+}
+
+template<OrderType S>
+PlaceResult Book::match_and_rest(OrderIndex index, TradeSink sink) {
+	Order* order = order_pool.at(index);
+	const Volume volume = order->get_volume();
+	PlaceResult result;
+	result.fills = match<S>(order, sink);
+
 	// 如果订单未完全成交，将其插入对应的 Limit
 	if (order->get_status() != FULFILLED) {
 		// Order is resting, add it to the map and the limit
-		id_to_order[order->get_id()] = order; // Add resting order to map
-		insert_order(order); // insert_order now takes Order*
-	} else {
-		// Incoming order was fully matched and never rested, destroy it
-		order->~Order(); // Explicitly call destructor for placement new
-		order_pool.free(order); // Return memory to pool
+		ORDERBOOK_STAT(stats.id_lookups++; std::size_t buckets = id_to_order.bucket_count();)
+		id_to_order[order->get_id()] = index; // Add resting order to map
+		ORDERBOOK_STAT(stats.id_rehashes += id_to_order.bucket_count() != buckets;)
+		insert_order<S>(index);
+		result.status = ACTIVE;
+		result.remaining = order->get_volume();
+		result.filled = volume - result.remaining;
+		result.handle = {index, order_pool.get_generation(index)};
+		return result;
 	}
-    // --- End 之前逻辑 ---
-
-	return trades;
+	// Incoming order was fully matched and never rested, destroy it
+	order_pool.destroy(index); // Return memory to pool
+	result.status = FULFILLED;
+	result.filled = volume;
+	return result;
 }
 
 void Book::delete_order(ID id) {
-	if (not id_to_order.contains(id))
-		return;
+	ORDERBOOK_STAT(stats.id_lookups++;)
 	auto it = id_to_order.find(id);
 	if (it == id_to_order.end()) {
 		// Order not found in map, might have been fulfilled already or never existed
 		return;
 	}
-	Order* order = it->second;
+	OrderIndex index = it->second;
+	Order* order = order_pool.at(index);
 	/*if (not buy_limits.contains(order->get_price()) and not sell_limits.contains(order->get_price()))
 		return;*/
 	if (order->get_status() == ACTIVE) {
-		delete_order(order, order->get_type() == BUY); // Remove from Limit list
+		// Remove from Limit list
+		if (order->get_type() == BUY)
+			delete_order<BUY>(index);
+		else
+			delete_order<SELL>(index);
+		ORDERBOOK_STAT(stats.id_lookups++;)
 		id_to_order.erase(it); // Remove from map
-		order->~Order(); // Explicitly call destructor
-		order_pool.free(order); // Return memory to pool
+		order_pool.destroy(index); // Return memory to pool (O(1)), every handle to this order is now stale
+		publish_level_updates();
 	}
 	// If status is not ACTIVE (e.g., FULFILLED), it should have been removed already.
 	// If it's DELETED, it means it was already processed for deletion.
 }
 
+bool Book::cancel(OrderHandle handle) {
+	if (not order_pool.is_current(handle.index, handle.generation))
+		return false; // Stale handle: the order was filled or deleted, its slot may hold another order
+	Order* order = order_pool.at(handle.index);
+	if (order->get_type() == BUY)
+		delete_order<BUY>(handle.index);
+	else
+		delete_order<SELL>(handle.index);
+	ORDERBOOK_STAT(stats.id_lookups++;)
+	id_to_order.erase(order->get_id()); // The id has to be forgotten for the ID API and the duplicate check
+	order_pool.destroy(handle.index);
+	publish_level_updates();
+	return true;
+}
+
+PlaceResult Book::amend_order(ID id, Price price, Volume volume, TradeSink sink) {
+	ORDERBOOK_STAT(stats.id_lookups++;)
+	auto it = id_to_order.find(id);
+	if (it == id_to_order.end())
+		return PlaceResult::rejected(UNKNOWN_ORDER);
+	OrderIndex index = it->second;
+	PlaceResult result = order_pool.at(index)->get_type() == BUY ? amend<BUY>(index, price, volume, sink) : amend<SELL>(index, price, volume, sink);
+	publish_level_updates();
+	return result;
+}
+
+PlaceResult Book::amend_order(ID id, Price price, Volume volume, Trades& trades) {
+	return amend_order(id, price, volume, [&trades](const Trade& trade) { trades.push_back(trade); });
+}
+
+PlaceResult Book::amend_order(OrderHandle handle, Price price, Volume volume, TradeSink sink) {
+	if (not order_pool.is_current(handle.index, handle.generation))
+		return PlaceResult::rejected(UNKNOWN_ORDER);
+	PlaceResult result = order_pool.at(handle.index)->get_type() == BUY ? amend<BUY>(handle.index, price, volume, sink)
+			: amend<SELL>(handle.index, price, volume, sink);
+	publish_level_updates();
+	return result;
+}
+
+template<OrderType S>
+PlaceResult Book::amend(OrderIndex index, Price price, Volume volume, TradeSink sink) {
+	Order* order = order_pool.at(index);
+	PlaceResult result;
+	result.handle = {index, order_pool.get_generation(index)};
+	if (price <= 0) {
+		ORDERBOOK_STAT(stats.invalid_price_rejects++;)
+		result.status = ACTIVE;
+		result.remaining = order->get_volume();
+		result.reject_reason = INVALID_PRICE;
+		return result;
+	}
+	// 改量为 0 即撤单
+	if (volume == 0) {
+		delete_order<S>(index);
+		ORDERBOOK_STAT(stats.id_lookups++;)
+		id_to_order.erase(order->get_id());
+		order_pool.destroy(index);
+		return PlaceResult(); // DELETED, nothing traded
+	}
+
+	if (price == order->get_price()) {
+		Limit* limit = find_limit<S>(price);
+		if (volume <= order->get_volume()) {
+			// 减量: 原地修改, 保留时间优先级
+			limit->resize_order(index, volume);
+			if (order_feed)
+				publish_order_event(MODIFY_ORDER, S, order->get_id(), price, volume);
+		} else {
+			// 增量: 失去时间优先级, 排到同一价位的队尾 (价位不会被删除)
+			if (order_feed)
+				publish_order_event(DELETE_ORDER, S, order->get_id(), price, order->get_volume());
+			limit->delete_order(index);
+			order->set_volume(volume);
+			order->set_status(ACTIVE);
+			limit->insert_order(index);
+			if (order_feed)
+				publish_order_event(ADD_ORDER, S, order->get_id(), price, volume);
+		}
+		level_changed<S>(limit);
+		result.status = ACTIVE;
+		result.remaining = volume;
+		return result;
+	}
+
+	// 改价: 从原价位摘下后按新价格撮合, 剩余部分挂到新价位; 订单始终占用同一个内存池槽位, 句柄不变
+	delete_order<S>(index);
+	order->set_price(price);
+	order->set_volume(volume);
+	order->set_status(ACTIVE);
+	result.fills = match<S>(order, sink);
+	result.filled = volume - order->get_volume();
+	if (order->get_status() == FULFILLED) {
+		ORDERBOOK_STAT(stats.id_lookups++;)
+		id_to_order.erase(order->get_id());
+		order_pool.destroy(index);
+		result.status = FULFILLED;
+		result.handle = {};
+		return result;
+	}
+	insert_order<S>(index);
+	result.status = ACTIVE;
+	result.remaining = order->get_volume();
+	return result;
+}
+OrderHandle Book::find_handle(ID id) {
+	ORDERBOOK_STAT(stats.id_lookups++;)
+	auto it = id_to_order.find(id);
+	if (it == id_to_order.end())
+		return {};
+	return {it->second, order_pool.get_generation(it->second)};
+}
+
+OrderHandle Book::prepare_command(const Command& command) {
+	if (command.type == PLACE) {
+		Limit* limit = command.side == BUY ? find_limit<BUY>(command.price) : find_limit<SELL>(command.price);
+		if (limit)
+			__builtin_prefetch(limit, 1);
+		return {};
+	}
+	OrderHandle handle = find_handle(command.id);
+	if (handle.is_valid())
+		__builtin_prefetch(order_pool.at(handle.index), 1);
+	return handle;
+}
+
+void Book::prefetch_command(const Command& command, OrderHandle handle) {
+	if (command.type == PLACE) {
+		// 会成交的订单先碰对手方最优价位的队首, 否则排到本方价位的队尾
+		bool crosses = command.side == BUY ? best_sell and command.price >= best_sell : best_buy and command.price <= best_buy;
+		Limit* limit = command.side == BUY ? (crosses ? find_limit<SELL>(best_sell) : find_limit<BUY>(command.price))
+				: (crosses ? find_limit<BUY>(best_buy) : find_limit<SELL>(command.price));
+		if (limit)
+			limit->prefetch_ends();
+		return;
+	}
+	if (not order_pool.is_current(handle.index, handle.generation))
+		return;
+	// 撤单/改单要修改订单所在的价位, 链表模式下还要修改前后相邻的订单 (队列模式下 prev 是队列位置而不是索引)
+	Order* order = order_pool.at(handle.index);
+	Limit* limit = order->get_type() == BUY ? find_limit<BUY>(order->get_price()) : find_limit<SELL>(order->get_price());
+	if (limit)
+		__builtin_prefetch(limit, 1);
+	if (not config.queue_levels) {
+		if (order->get_prev() != NO_ORDER)
+			__builtin_prefetch(order_pool.at(order->get_prev()), 1);
+		if (order->get_next() != NO_ORDER)
+			__builtin_prefetch(order_pool.at(order->get_next()), 1);
+	}
+}
+
+void Book::process_batch(std::span<const Command> commands, TradeSink sink, std::span<PlaceResult> results) {
+	// 预取流水线: 第 i 条命令执行前, 第 i + BATCH_LOOKUP_DISTANCE 条命令查 ID, 第 i + BATCH_PREFETCH_DISTANCE 条命令预取价位和订单
+	// 提前查到的句柄只在订单仍占用同一槽位时才使用 (期间被成交或撤单则代数已变), 否则执行时重新按 ID 查找, 结果与逐条执行一致
+	static_assert(BATCH_PREFETCH_DISTANCE < BATCH_LOOKUP_DISTANCE);
+	constexpr std::size_t RING = 2 * BATCH_LOOKUP_DISTANCE;
+	OrderHandle handles[RING];
+	const std::size_t size = commands.size();
+	for (std::size_t i = 0; i < std::min(size, BATCH_LOOKUP_DISTANCE); i++)
+		handles[i % RING] = prepare_command(commands[i]);
+	for (std::size_t i = 0; i < std::min(size, BATCH_PREFETCH_DISTANCE); i++)
+		prefetch_command(commands[i], handles[i % RING]);
+
+	for (std::size_t i = 0; i < size; i++) {
+		if (i + BATCH_LOOKUP_DISTANCE < size)
+			handles[(i + BATCH_LOOKUP_DISTANCE) % RING] = prepare_command(commands[i + BATCH_LOOKUP_DISTANCE]);
+		if (i + BATCH_PREFETCH_DISTANCE < size)
+			prefetch_command(commands[i + BATCH_PREFETCH_DISTANCE], handles[(i + BATCH_PREFETCH_DISTANCE) % RING]);
+
+		const Command& command = commands[i];
+		OrderHandle handle = handles[i % RING];
+		PlaceResult result;
+		switch (command.type) {
+			case PLACE:
+				result = place_order(command.id, command.agent_id, command.side, command.price, command.volume, sink);
+				break;
+			case CANCEL:
+				if (not order_pool.is_current(handle.index, handle.generation))
+					handle = find_handle(command.id);
+				result.reject_reason = cancel(handle) ? NOT_REJECTED : UNKNOWN_ORDER;
+				break;
+			case AMEND:
+				if (order_pool.is_current(handle.index, handle.generation))
+					result = amend_order(handle, command.price, command.volume, sink);
+				else
+					result = amend_order(command.id, command.price, command.volume, sink);
+				break;
+			default:
+				continue;
+		}
+		if (not results.empty())
+			results[i] = result;
+	}
+}
 
 bool Book::is_in_buy_limits(Price price) {
-	return buy_limits.contains(price);
+	return find_limit<BUY>(price) != nullptr;
 }
 
 bool Book::is_in_sell_limits(Price price) {
-	return sell_limits.contains(price);
+	return find_limit<SELL>(price) != nullptr;
 }
 
-void Book::update_best_buy() {
-	if (not buy_tree.empty())
-		best_buy = *buy_tree.rbegin();
-	else
-		best_buy = 0;
+template<OrderType S>
+LimitPointer Book::find_limit(Price price) {
+	if (ladder<S>().covers(price))
+		return ladder<S>().get(price);
+
+	auto it = limits<S>().find(price);
+	return it != limits<S>().end() ? it->second : nullptr;
 }
 
-void Book::update_best_sell() {
-	if (not sell_tree.empty())
-		best_sell = *sell_tree.begin();
+template<OrderType S>
+void Book::erase_limit(LimitPointer limit) {
+	Price price = limit->get_price();
+
+	if (ladder<S>().covers(price))
+		ladder<S>().clear(price);
 	else
-		best_sell = 0;
+		limits<S>().erase(price);
+
+	if (bitmap<S>().covers(price))
+		bitmap<S>().clear(price);
+	else if (not ladder<S>().covers(price))
+		tree<S>().erase(price);
+	remove_depth<S>(price);
+
+	// 保留队列缓冲区给下一个价格水平, 避免价格水平频繁增删时反复 malloc/free
+	if (limit->is_queued() and spare_queues.size() < MAX_SPARE_QUEUES)
+		spare_queues.push_back(limit->take_queue());
+	limit_pool.destroy(limit); // Return memory to pool
+	ORDERBOOK_STAT(stats.levels_destroyed++;)
 }
 
-void Book::check_for_empty_buy_limit(Price price) {
-	if (is_in_buy_limits(price) and buy_limits[price]->is_empty()) {
-		Limit* limit_to_delete = buy_limits[price]; // Get pointer before erasing
-		buy_limits.erase(price);
-		buy_tree.erase(price);
-		limit_to_delete->~Limit(); // Explicitly call destructor
-		limit_pool.free(limit_to_delete); // Return memory to pool
-		if (price == best_buy)
-			update_best_buy();
+template<OrderType S>
+void Book::update_best() {
+	// Called once the previous best level is gone: nothing better is left on this side
+	ORDERBOOK_STAT(stats.best_recomputations++;)
+	Price& best_price = best<S>();
+	Price best_tree = 0;
+	Price best_band = 0;
+	if constexpr (S == BUY) {
+		best_tree = tree<S>().empty() ? 0 : *tree<S>().rbegin();
+		if (bitmap<S>().is_enabled())
+			best_band = bitmap<S>().find_highest_at_or_below(best_price);
+		else if (ladder<S>().is_enabled())
+			best_band = ladder<S>().find_highest_at_or_below(best_price);
+	} else {
+		best_tree = tree<S>().empty() ? 0 : *tree<S>().begin();
+		if (bitmap<S>().is_enabled())
+			best_band = bitmap<S>().find_lowest_at_or_above(best_price);
+		else if (ladder<S>().is_enabled())
+			best_band = ladder<S>().find_lowest_at_or_above(best_price);
 	}
+	// 0 means no level: only keep a band level if the tree has none or a worse one
+	best_price = best_band and (not best_tree or is_better<S>(best_band, best_tree)) ? best_band : best_tree;
 }
 
-void Book::check_for_empty_sell_limit(Price price) {
-	if (is_in_sell_limits(price) and sell_limits[price]->is_empty()) {
-		Limit* limit_to_delete = sell_limits[price]; // Get pointer before erasing
-		sell_limits.erase(price);
-		sell_tree.erase(price);
-		limit_to_delete->~Limit(); // Explicitly call destructor
-		limit_pool.free(limit_to_delete); // Return memory to pool
-		if (price == best_sell)
-			update_best_sell();
+template<OrderType S>
+void Book::check_for_empty_limit(Price price) {
+	Limit* limit = find_limit<S>(price);
+	if (limit and limit->is_empty()) {
+		erase_limit<S>(limit);
+		if (price == best<S>())
+			update_best<S>();
 	}
 }
 
-void Book::insert_order(Order* order) { // Accept raw pointer
-	Price price = order->get_price();
-	bool is_buy = order->get_type() == BUY;
+template<OrderType S>
+void Book::insert_order(OrderIndex index) {
+	Price price = order_pool.at(index)->get_price();
 
-	Limit* limit = get_or_create_limit(price, is_buy); // Get raw pointer
+	Limit* limit = get_or_create_limit<S>(price); // Get raw pointer
 
 	if (!limit) return;
 
-	if (is_buy and (not best_buy or price > best_buy)) {
-		best_buy = price;
-	} else if (not is_buy and (not best_sell or price < best_sell)) {
-		best_sell = price;
-	}
-
-	limit->insert_order(order);
-}
-
-Limit* Book::get_or_create_limit(Price price, bool is_buy) { // Return raw pointer
-	// LimitPointer limit;
-	// if (is_buy) {
-	// 	if (is_in_buy_limits(price)) {
-	// 		limit = buy_limits[price];
-	// 	} else {
-	// 		limit = std::make_shared<Limit>(price);
-	// 		buy_tree.insert(price);
-	// 		buy_limits[price] = limit;
-	// 	}
-	// } else {
-	// 	if (is_in_sell_limits(price)) {
-	// 		limit = sell_limits[price];
-	// 	} else {
-	// 		limit = std::make_shared<Limit>(price);
-	// 		sell_tree.insert(price);
-	// 		sell_limits[price] = limit;
-	// 	}
-	// }
-	// return limit;
-	auto& limits = is_buy ? buy_limits : sell_limits;
-	auto it = limits.find(price);
-
-	if (it != limits.end()) {
-		return it->second; // Limit 已存在，直接返回 Limit*
-	} else {
-		// Limit 不存在，需要使用内存池创建
-		auto& tree = is_buy ? buy_tree : sell_tree;
+	if (not best<S>() or is_better<S>(price, best<S>()))
+		best<S>() = price;
+
+	limit->insert_order(index);
+	level_changed<S>(limit);
+	if (order_feed)
+		publish_order_event(ADD_ORDER, S, order_pool.at(index)->get_id(), price, order_pool.at(index)->get_volume());
+}
 
-		// Limit 不存在，使用 limit_pool.malloc + placement new 创建
-		Limit* limit = static_cast<Limit*>(limit_pool.malloc());
-		if (!limit) {
-			throw std::bad_alloc();
+template<OrderType S>
+Limit* Book::get_or_create_limit(Price price) { // Return raw pointer
+	Limit* limit = find_limit<S>(price);
+	if (limit)
+		return limit; // Limit 已存在，直接返回 Limit*
+
+	// Limit 不存在，从 limit_pool 分配并构造
+	limit = limit_pool.construct(price, order_pool, config.queue_levels);
+	limit->set_stats(&stats);
+	ORDERBOOK_STAT(stats.levels_created++;)
+	if (config.queue_levels and not spare_queues.empty()) {
+		limit->give_queue(std::move(spare_queues.back()));
+		spare_queues.pop_back();
+	}
+
+	// 价格在阶梯范围内则直接放入数组，否则放入 map
+	if (ladder<S>().covers(price))
+		ladder<S>().set(price, limit);
+	else
+		limits<S>().emplace(price, limit); // Store raw pointer
+
+	// 价格排序由位图 (或阶梯数组) 负责，其余价格放入 tree
+	if (bitmap<S>().covers(price))
+		bitmap<S>().set(price);
+	else if (not ladder<S>().covers(price))
+		tree<S>().insert(price);
+
+	return limit; // Return raw pointer
+}
+
+// Helper function to remove order from its limit list (doesn't destroy the order object)
+template<OrderType S>
+void Book::delete_order(OrderIndex index) {
+	Price price = order_pool.at(index)->get_price();
+	Limit* limit = find_limit<S>(price);
+	if (not limit)
+		return;
+	if (order_feed)
+		publish_order_event(DELETE_ORDER, S, order_pool.at(index)->get_id(), price, order_pool.at(index)->get_volume());
+	limit->delete_order(index);
+	level_changed<S>(limit);
+	check_for_empty_limit<S>(price);
+}
+
+template<OrderType S>
+void Book::level_changed(LimitPointer limit) {
+	// 价位清空时由 erase_limit 从视图中移除
+	if (depth<S>().is_enabled() and not limit->is_empty())
+		depth<S>().update(limit->get_price(), limit->get_total_volume(), limit->get_length());
+	if (not level_feed)
+		return;
+	// 同一条命令多次修改同一价位 (逐笔撮合, 撤单后重新挂单) 只保留最终状态
+	Price price = limit->get_price();
+	for (LevelUpdate& update : pending_levels) {
+		if (update.price == price and update.side == S) {
+			update.volume = limit->get_total_volume();
+			update.count = limit->get_length();
+			return;
 		}
-		try {
-			new(limit) Limit(price); // Placement new
-		} catch (...) {
-			limit_pool.free(limit);
-			throw;
+	}
+	pending_levels.push_back({0, limit->get_total_volume(), limit->get_length(), price, S});
+}
+
+void Book::publish_level_updates() {
+	for (LevelUpdate& update : pending_levels) {
+		update.sequence = level_sequence++;
+		if (not level_feed->try_push(update)) {
+			ORDERBOOK_STAT(stats.level_updates_dropped++;)
 		}
+	}
+	pending_levels.clear();
+}
 
-		// 将新的 Limit* 添加到 map 和 tree 中
-		limits.emplace(price, limit); // Store raw pointer
-		tree.insert(price);
+void Book::publish_order_event(OrderEventType type, OrderType side, ID id, Price price, Volume volume, ID incoming_id) {
+	OrderEvent event{order_sequence++, id, incoming_id, volume, price, type, side};
+	if (not order_feed->try_push(event)) {
+		ORDERBOOK_STAT(stats.order_events_dropped++;)
+	}
+}
 
-		return limit; // Return raw pointer
+void Book::set_order_feed(OrderEventRing* ring) {
+	order_feed = ring;
+}
+
+void Book::set_level_feed(LevelRing* ring) {
+	level_feed = ring;
+	pending_levels.reserve(MAX_PENDING_LEVELS);
+}
+
+template<OrderType S>
+void Book::remove_depth(Price price) {
+	DepthView& view = depth<S>();
+	if (not view.is_enabled() or not view.remove(price))
+		return;
+	// 满视图少了一档: 补上视图末档之后的下一个价位 (视图为空时从被删价位往后找)
+	Price next = next_level<S>(view.is_empty() ? price : view.back().price);
+	if (next == 0)
+		return;
+	Limit* limit = find_limit<S>(next);
+	view.push_back({next, limit->get_total_volume(), limit->get_length()});
+}
+
+template<OrderType S>
+std::size_t Book::collect_depth(std::span<DepthLevel> out) {
+	std::size_t count = 0;
+	for (Price price = best<S>(); price != 0 and count < out.size(); price = next_level<S>(price)) {
+		Limit* limit = find_limit<S>(price);
+		out[count++] = {price, limit->get_total_volume(), limit->get_length()};
 	}
+	return count;
+}
 
+std::size_t Book::get_depth(OrderType type, std::span<DepthLevel> out) {
+	if (config.depth_levels > 0)
+		return (type == BUY ? buy_depth : sell_depth).copy(out);
+	return type == BUY ? collect_depth<BUY>(out) : collect_depth<SELL>(out);
 }
 
-// Helper function to remove order from its limit list (doesn't destroy the order object)
-void Book::delete_order(Order* order, bool is_buy) { // Accept raw pointer
-	if (is_buy) {
-		if (not is_in_buy_limits(order->get_price()))
-			return;
-		Limit* limit = buy_limits[order->get_price()];
-		if (limit) limit->delete_order(order);
-		check_for_empty_buy_limit(order->get_price());
-	} else {
-		if (not is_in_sell_limits(order->get_price()))
-			return;
-		Limit* limit = sell_limits[order->get_price()];
-		if (limit) limit->delete_order(order);
-		check_for_empty_sell_limit(order->get_price());
+bool Book::save_snapshot(const std::string& path) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		return false;
+	std::vector<LimitPointer> buy_levels = get_levels(BUY);
+	std::vector<LimitPointer> sell_levels = get_levels(SELL);
+	SnapshotHeader header{};
+	std::memcpy(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic));
+	header.version = SnapshotHeader::VERSION;
+	header.nb_levels = buy_levels.size() + sell_levels.size();
+	header.nb_orders = id_to_order.size();
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	// 订单记录攒满一块再写, 避免逐条调用 write
+	std::vector<SnapshotOrder> chunk;
+	chunk.reserve(SNAPSHOT_CHUNK);
+	auto flush = [&file, &chunk]() {
+		file.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size() * sizeof(SnapshotOrder)));
+		chunk.clear();
+	};
+	auto write_level = [&](LimitPointer limit, OrderType side) {
+		SnapshotLevel level{limit->get_price(), side, {}, limit->get_length()};
+		file.write(reinterpret_cast<const char*>(&level), sizeof(level));
+		limit->for_each_order([&](OrderIndex index) {
+			Order* order = order_pool.at(index);
+			const OrderInfo& info = order_pool.cold(index);
+			chunk.push_back({order->get_id(), info.agent_id, order->get_volume(), info.initial_volume});
+			if (chunk.size() == SNAPSHOT_CHUNK)
+				flush();
+		});
+		flush();
+	};
+	// 每一侧从最优价位开始写
+	for (auto it = buy_levels.rbegin(); it != buy_levels.rend(); ++it)
+		write_level(*it, BUY);
+	for (LimitPointer limit : sell_levels)
+		write_level(limit, SELL);
+	return file.good();
+}
+
+bool Book::load_snapshot(const std::string& path) {
+	if (not id_to_order.empty())
+		return false;
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+	const std::uint64_t size = static_cast<std::uint64_t>(file.tellg());
+	file.seekg(0);
+	SnapshotHeader header;
+	if (size < sizeof(header) or not file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+	// 两个计数先各自受文件大小约束再相乘, 构造的文件头不会溢出
+	const std::uint64_t body = size - sizeof(header);
+	if (std::memcmp(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic)) != 0 or header.version != SnapshotHeader::VERSION
+			or header.nb_levels > body / sizeof(SnapshotLevel) or header.nb_orders > body / sizeof(SnapshotOrder)
+			or body != header.nb_levels * sizeof(SnapshotLevel) + header.nb_orders * sizeof(SnapshotOrder))
+		return false;
+
+	// 第一遍只读价位头, 跳过订单: 全部通过校验 (且各价位订单数之和等于文件头) 才开始修改订单簿
+	std::uint64_t listed = 0;
+	for (std::uint64_t i = 0; i < header.nb_levels; i++) {
+		SnapshotLevel level;
+		if (not file.read(reinterpret_cast<char*>(&level), sizeof(level)) or level.side > SELL or level.price == 0 or level.nb_orders == 0
+				or level.nb_orders > header.nb_orders - listed)
+			return false;
+		listed += level.nb_orders;
+		file.seekg(static_cast<std::streamoff>(level.nb_orders * sizeof(SnapshotOrder)), std::ios::cur);
+	}
+	if (listed != header.nb_orders)
+		return false;
+	file.seekg(sizeof(header));
+
+	// 之后的读错误, 空订单记录或重复的订单号: 撤掉已载入的订单, 订单簿回到空的状态
+	auto rollback = [this]() {
+		std::vector<ID> ids;
+		ids.reserve(id_to_order.size());
+		for (auto& [id, index] : id_to_order)
+			ids.push_back(id);
+		for (ID id : ids)
+			delete_order(id);
+		return false;
+	};
+	// 一次性分配好内存池和哈希表, 之后逐块读入订单并直接挂到价位上
+	order_pool.reserve(header.nb_orders);
+	id_to_order.reserve(header.nb_orders);
+	std::vector<SnapshotOrder> chunk(SNAPSHOT_CHUNK);
+	for (std::uint64_t i = 0; i < header.nb_levels; i++) {
+		SnapshotLevel level;
+		if (not file.read(reinterpret_cast<char*>(&level), sizeof(level)))
+			return rollback();
+		for (std::uint64_t remaining = level.nb_orders; remaining > 0;) {
+			std::size_t count = std::min<std::uint64_t>(remaining, SNAPSHOT_CHUNK);
+			if (not file.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(count * sizeof(SnapshotOrder))))
+				return rollback();
+			std::span<const SnapshotOrder> orders(chunk.data(), count);
+			if (std::any_of(orders.begin(), orders.end(), [](const SnapshotOrder& record) { return record.volume == 0; }))
+				return rollback();
+			if (not (level.side == BUY ? load_orders<BUY>(level.price, orders) : load_orders<SELL>(level.price, orders)))
+				return rollback();
+			remaining -= count;
+		}
+	}
+	publish_level_updates();
+	return true;
+}
+
+template<OrderType S>
+bool Book::load_orders(Price price, std::span<const SnapshotOrder> orders) {
+	Limit* limit = get_or_create_limit<S>(price);
+	if (not best<S>() or is_better<S>(price, best<S>()))
+		best<S>() = price;
+	bool loaded = true;
+	for (const SnapshotOrder& record : orders) {
+		OrderIndex index = order_pool.construct(record.id, S, price, record.volume);
+		if (not id_to_order.emplace(record.id, index).second) {
+			order_pool.destroy(index);
+			loaded = false;
+			break;
+		}
+		order_pool.cold(index) = {record.agent_id, record.initial_volume};
+		limit->insert_order(index);
+		if (order_feed)
+			publish_order_event(ADD_ORDER, S, record.id, price, record.volume);
 	}
+	level_changed<S>(limit);
+	check_for_empty_limit<S>(price); // Only if the first record was a duplicate
+	return loaded;
+}
+
+std::vector<LimitPointer> Book::get_levels(OrderType type) {
+	bool is_buy = type == BUY;
+	PriceLimitMap& limits = is_buy ? buy_limits : sell_limits;
+
+	std::vector<LimitPointer> levels;
+	levels.reserve(limits.size() + (is_buy ? buy_ladder : sell_ladder).get_count());
+	(is_buy ? buy_ladder : sell_ladder).collect(levels);
+	for (auto& [price, limit] : limits)
+		levels.push_back(limit);
+	std::sort(levels.begin(), levels.end(), [](LimitPointer a, LimitPointer b) { return a->get_price() < b->get_price(); });
+	return levels;
 }
 
 void Book::print() {
-	for (Price price : buy_tree){
-		buy_limits[price]->print();
+	for (LimitPointer limit : get_levels(BUY)){
+		limit->print();
 	}
 	std::cout << "==== BUY SIDE ===" << std::endl;
 	std::cout << "Best buy: " << best_buy << std::endl;
 	std::cout << "Best sell: " << best_sell << std::endl;
 	std::cout << "=== SELL SIDE ===" << std::endl;
-	for (Price price : sell_tree){
-		sell_limits[price]->print();
+	for (LimitPointer limit : get_levels(SELL)){
+		limit->print();
 	}
 }
 
@@ -310,12 +837,37 @@ PriceLimitMap& Book::get_sell_limits() { return sell_limits; }
 Price Book::get_best_buy(){ return best_buy; }
 Price Book::get_best_sell() { return best_sell; }
 Orders& Book::get_id_to_order() { return id_to_order; }
+Order* Book::get_order(ID id) {
+	auto it = id_to_order.find(id);
+	return it != id_to_order.end() ? order_pool.at(it->second) : nullptr;
+}
+const OrderInfo* Book::get_order_info(ID id) {
+	auto it = id_to_order.find(id);
+	return it != id_to_order.end() ? &order_pool.cold(it->second) : nullptr;
+}
+const BookConfig& Book::get_config() const { return config; }
+BookStats Book::get_stats() const {
+	BookStats snapshot = stats;
+	snapshot.live_orders = id_to_order.size();
+	snapshot.buy_levels = buy_limits.size() + buy_ladder.get_count();
+	snapshot.sell_levels = sell_limits.size() + sell_ladder.get_count();
+	snapshot.order_slabs = order_pool.get_slab_count();
+	snapshot.limit_slabs = limit_pool.get_slab_count();
+	snapshot.id_buckets = id_to_order.bucket_count();
+	return snapshot;
+}
+void Book::reset_stats() { stats = BookStats(); }
 OrderStatus Book::get_order_status(ID id) {
 	auto it = id_to_order.find(id); // Find the order
 	if (it != id_to_order.end()) {
 		// Order found, return its status
-		return it->second->get_status();
+		return order_pool.at(it->second)->get_status();
 	}
 	// Order not found in the map (might be fulfilled or deleted)
 	return DELETED; // Or potentially another status indicating 'not found'
 }
+OrderStatus Book::get_order_status(OrderHandle handle) {
+	if (not order_pool.is_current(handle.index, handle.generation))
+		return DELETED;
+	return order_pool.at(handle.index)->get_status();
+}
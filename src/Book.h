@@ -3,29 +3,82 @@
 
 #include <unordered_map>
 #include <set>
+#include <span>
+#include <string>
 #include "Limit.h"
-#include "boost/pool/object_pool.hpp"
+#include "BookConfig.h"
+#include "BookStats.h"
+#include "Command.h"
+#include "DepthView.h"
+#include "LevelFeed.h"
+#include "OrderFeed.h"
+#include "OrderHandle.h"
+#include "PlaceResult.h"
+#include "PriceBitmap.h"
+#include "PriceLadder.h"
+#include "Snapshot.h"
+#include "SlabPool.h"
 
 using PriceTree = std::set<Price>;
 using PriceLimitMap = std::unordered_map<Price, LimitPointer>;
-using Orders = std::unordered_map<ID, OrderPointer>;
+using Orders = std::unordered_map<ID, OrderIndex>;
 
 class Book {
 private:
-	PriceTree buy_tree; /**< tree containing all limits of the buy side */
-	PriceLimitMap buy_limits; /**< Maps the buy limit prices to their limit objects (now raw pointers)*/
+	BookConfig config; /**< Options the book was built with */
 
-	PriceTree sell_tree; /**< tree containing all limits of the sell side */
-	PriceLimitMap sell_limits; /**< Maps the sell limit prices to their limit objects (now raw pointers)*/
+	PriceLadder buy_ladder; /**< Dense array of the buy limits inside the band (ladder mode only) */
+	PriceBitmap buy_bitmap; /**< Occupied ticks of the buy side inside the band (bitmap mode only) */
+	PriceTree buy_tree; /**< tree containing the buy limit prices that are not tracked by the ladder or the bitmap */
+	PriceLimitMap buy_limits; /**< Maps the buy limit prices that are not in the ladder to their limit objects */
+
+	PriceLadder sell_ladder; /**< Dense array of the sell limits inside the band (ladder mode only) */
+	PriceBitmap sell_bitmap; /**< Occupied ticks of the sell side inside the band (bitmap mode only) */
+	PriceTree sell_tree; /**< tree containing the sell limit prices that are not tracked by the ladder or the bitmap */
+	PriceLimitMap sell_limits; /**< Maps the sell limit prices that are not in the ladder to their limit objects */
+
+	DepthView buy_depth; /**< Best buy levels, maintained when config.depth_levels is set */
+	DepthView sell_depth; /**< Best sell levels, maintained when config.depth_levels is set */
+
+	LevelRing* level_feed; /**< Ring receiving the L2 updates, nullptr when the feed is off */
+	std::vector<LevelUpdate> pending_levels; /**< Level updates of the current command, one per level, published once it is done */
+	std::uint64_t level_sequence; /**< Sequence number of the next L2 update */
+	OrderEventRing* order_feed; /**< Ring receiving the L3 events, nullptr when the feed is off */
+	std::uint64_t order_sequence; /**< Sequence number of the next L3 event */
 
 	Price best_buy; /**< Pointer to the best (highest) buy limit */
 	Price best_sell; /**<Pointer to the best (lowest) sell limit */
 
-	Orders id_to_order; /**< Maps IDs to the corresponding order (now raw pointers) */
+	Orders id_to_order; /**< Maps IDs to the pool index of the corresponding order */
 
-	boost::object_pool<Order> order_pool;
-	boost::object_pool<Limit> limit_pool;
+	OrderPool order_pool; /**< O(1) allocator of the orders, also holds their cold data and handle generations */
+	SlabPool<Limit> limit_pool; /**< O(1) allocator of the limits */
+	std::vector<std::vector<OrderIndex>> spare_queues; /**< Buffers of emptied queued limits, reused by the next ones */
+
+	static constexpr std::size_t MAX_SPARE_QUEUES = 64; /**< Number of spare queue buffers kept */
+	static constexpr std::size_t BATCH_LOOKUP_DISTANCE = 8; /**< Commands ahead whose ids are looked up by process_batch */
+	static constexpr std::size_t BATCH_PREFETCH_DISTANCE = 4; /**< Commands ahead whose limits and orders are prefetched */
+	static constexpr std::size_t SNAPSHOT_CHUNK = 4096; /**< Order records read or written at once by the snapshots */
+	static constexpr std::size_t MAX_PENDING_LEVELS = 64; /**< Level updates of one command held without allocation (more grow the buffer) */
+
+	BookStats stats; /**< Instrumentation counters, only updated when compiled with ORDERBOOK_STATS */
 	
+	/** Side selectors, resolved at compile time so that the matching kernels carry no side branch */
+	template<OrderType S> PriceLadder& ladder() { if constexpr (S == BUY) return buy_ladder; else return sell_ladder; }
+	template<OrderType S> PriceBitmap& bitmap() { if constexpr (S == BUY) return buy_bitmap; else return sell_bitmap; }
+	template<OrderType S> PriceTree& tree() { if constexpr (S == BUY) return buy_tree; else return sell_tree; }
+	template<OrderType S> PriceLimitMap& limits() { if constexpr (S == BUY) return buy_limits; else return sell_limits; }
+	template<OrderType S> Price& best() { if constexpr (S == BUY) return best_buy; else return best_sell; }
+	template<OrderType S> DepthView& depth() { if constexpr (S == BUY) return buy_depth; else return sell_depth; }
+	/**
+	 * @brief Tells if a price is better than another one on a side (higher for buy, lower for sell)
+	 * @return true if price is better than other
+	 */
+	template<OrderType S> static constexpr bool is_better(Price price, Price other) {
+		if constexpr (S == BUY) return price > other; else return price < other;
+	}
+	static constexpr OrderType opposite(OrderType type) { return type == BUY ? SELL : BUY; }
+
 	/**
 	 * @brief Checks if a limit is already in the buy book
 	 * @param price price limit to check
@@ -39,62 +92,326 @@ private:
 	 */
 	bool is_in_sell_limits(Price price);
 	/**
-	 * @brief Updates the best_buy attribute after filling a limit
+	 * @brief Looks a limit up in the ladder or, for prices outside of it, in the hash map
+	 * @tparam S side of the book
+	 * @param price limit price
+	 * @return the limit at this price or nullptr if there is none
 	 */
-	void update_best_buy();
+	template<OrderType S>
+	LimitPointer find_limit(Price price);
 	/**
-	 * @brief Updates the best_sell attribute after filling a limit
+	 * @brief Removes a limit from the ladder or the hash map, and from the bitmap or the tree, then returns it to the pool
+	 * @tparam S side of the book
+	 * @param limit limit to remove
 	 */
-	void update_best_sell();
+	template<OrderType S>
+	void erase_limit(LimitPointer limit);
 	/**
-	 * @brief Checks for an empty buy limit (i.e. no order)
-	 * @param price price limit
+	 * @brief Updates the best price of a side after its best limit was emptied
+	 * @tparam S side of the book
 	 */
-	void check_for_empty_buy_limit(Price price);
+	template<OrderType S>
+	void update_best();
 	/**
-	 * @brief checks for an empty sell limit (i.e. no order)
+	 * @brief Checks for an empty limit (i.e. no order) and removes it
+	 * @tparam S side of the book
 	 * @param price price limit
 	 */
-	void check_for_empty_sell_limit(Price price);
+	template<OrderType S>
+	void check_for_empty_limit(Price price);
 	/**
 	 * @brief Inserts an order into the book at its corresponding limit price
-	 * @param order pointer to the order to place
+	 * @tparam S side of the order
+	 * @param index pool index of the order to place
 	 */
-	void insert_order(Order* order); // Accept raw pointer
+	template<OrderType S>
+	void insert_order(OrderIndex index);
 	/**
 	 * @brief Used to get a reference to a limit at a certain price, creates it if it does not exist
+	 * @tparam S side of the book
 	 * @param price limit price
-	 * @param is_buy if it is the buy side
 	 * @return the reference to the corresponding limit
 	 */
-	LimitPointer get_or_create_limit(Price price, bool is_buy);
+	template<OrderType S>
+	LimitPointer get_or_create_limit(Price price);
 	/**
 	 * @brief Helper function to delete an order in the book
-	 * @param order pointer to the order to delete
-	 * @param is_buy true if the order is a buy order false otherwise
+	 * @tparam S side of the order
+	 * @param index pool index of the order to delete
+	 */
+	template<OrderType S>
+	void delete_order(OrderIndex index);
+	/**
+	 * @brief Finds the next level of a side, going away from the best price
+	 * @tparam S side of the book
+	 * @param price price of a level of this side
+	 * @return the price of the first level worse than price, 0 if there is none
+	 */
+	template<OrderType S>
+	Price next_level(Price price);
+	/**
+	 * @brief Reports the new volume and order count of a level, right after an order was inserted in, deleted from or
+	 * matched against it: updates the depth view of its side (non-empty levels only, see remove_depth) and stages the
+	 * L2 update of the level, if these are enabled
+	 * @tparam S side of the book
+	 * @param limit level that was created or changed, possibly empty
+	 */
+	template<OrderType S>
+	void level_changed(LimitPointer limit);
+	/**
+	 * @brief Publishes the staged L2 updates on the feed, in the order their levels were first touched. A command
+	 * stages at most one update per level, which holds the final state of the level.
+	 */
+	void publish_level_updates();
+	/**
+	 * @brief Pushes an event on the L3 feed, which must be on
+	 * @param type kind of change
+	 * @param side side of the resting order
+	 * @param id id of the resting order
+	 * @param price price of the order, or of the trade
+	 * @param volume see OrderEvent::volume
+	 * @param incoming_id id of the incoming order for an execution
+	 */
+	void publish_order_event(OrderEventType type, OrderType side, ID id, Price price, Volume volume, ID incoming_id = 0);
+	/**
+	 * @brief Takes a level out of the depth view of its side, if enabled, and refills the view with the next level
+	 * @tparam S side of the book
+	 * @param price price of a level already removed from the price structures
+	 */
+	template<OrderType S>
+	void remove_depth(Price price);
+	/**
+	 * @brief Builds the best levels of a side by walking the price structures, without depth view
+	 * @tparam S side of the book
+	 * @param out array receiving the levels, best first
+	 * @return the number of levels written
+	 */
+	template<OrderType S>
+	std::size_t collect_depth(std::span<DepthLevel> out);
+	/**
+	 * @brief Checks if the opposite side holds enough volume at acceptable prices to fill an order, from the level
+	 * totals only (no order is read)
+	 * @tparam S side of the order
+	 * @param price limit price of the order
+	 * @param volume volume of the order
+	 * @return true if the order would be fully filled
+	 */
+	template<OrderType S>
+	bool can_fill(Price price, Volume volume);
+	/**
+	 * @brief Matches an incoming order against the opposite side while its price crosses the best opposite price
+	 * @tparam S side of the order
+	 * @param order incoming order, from the pool or not
+	 * @param sink callable invoked for each trade, in execution order
+	 * @return the number of trades
+	 */
+	template<OrderType S>
+	Length match(Order* order, TradeSink sink);
+	/**
+	 * @brief Matches an IOC, FOK or market order and drops what is left of it: the order is built on the stack, it
+	 * never takes a pool slot nor an entry of the id map
+	 * @tparam S side of the order
+	 * @param id id of the order
+	 * @param price limit price of the order
+	 * @param volume volume of the order
+	 * @param sink callable invoked for each trade, in execution order
+	 * @return the outcome of the order, FULFILLED or DELETED
+	 */
+	template<OrderType S>
+	PlaceResult match_immediate(ID id, Price price, Volume volume, TradeSink sink);
+	/**
+	 * @brief Matches a new order against the opposite side, then rests what is left of it
+	 * @tparam S side of the order
+	 * @param index pool index of the new order, destroyed here if it is fulfilled
+	 * @param sink callable invoked for each trade, in execution order
+	 * @return the outcome of the order, with its handle if it rests in the book
+	 */
+	template<OrderType S>
+	PlaceResult match_and_rest(OrderIndex index, TradeSink sink);
+	/**
+	 * @brief Looks an id up
+	 * @param id id of the order
+	 * @return the handle of the resting order with this id, an invalid handle if there is none
+	 */
+	OrderHandle find_handle(ID id);
+	/**
+	 * @brief First lookahead stage of process_batch: resolves the id of a cancel or an amend and starts loading the
+	 * order, or starts loading the limit a new order will join
+	 * @param command command executed BATCH_LOOKUP_DISTANCE commands later
+	 * @return the handle of the order a cancel or an amend refers to, or an invalid handle
+	 */
+	OrderHandle prepare_command(const Command& command);
+	/**
+	 * @brief Second lookahead stage of process_batch: starts loading the orders next to the one a cancel or an amend
+	 * unlinks, or the orders a new order will be matched against or queued behind
+	 * @param command command executed BATCH_PREFETCH_DISTANCE commands later
+	 * @param handle handle found by prepare_command
+	 */
+	void prefetch_command(const Command& command, OrderHandle handle);
+	/**
+	 * @brief Appends orders read from a snapshot to a level, creating the level if needed (no matching)
+	 * @tparam S side of the level
+	 * @param price price of the level
+	 * @param orders records of the level, in time priority
+	 * @return false if a record repeats the id of a loaded order: the records after it are not loaded
+	 */
+	template<OrderType S>
+	bool load_orders(Price price, std::span<const SnapshotOrder> orders);
+	/**
+	 * @brief Changes the price and/or volume of a resting order, see amend_order
+	 * @tparam S side of the order
+	 * @param index pool index of the order, which stays in its slot unless the amend fills it
 	 */
-	void delete_order(Order* order, bool is_buy); // Accept raw pointer
+	template<OrderType S>
+	PlaceResult amend(OrderIndex index, Price price, Volume volume, TradeSink sink);
 
 public:
-	// Increase initial chunk sizes significantly for the pools
-	Book(): buy_tree(), buy_limits(), sell_tree(), sell_limits(), best_buy(0), best_sell(0), order_pool(2048), limit_pool(512){}
+	Book(): Book(BookConfig()) {}
+	explicit Book(const BookConfig& config);
+	Book(const Book&) = delete;
+	Book& operator=(const Book&) = delete;
+	~Book();
 
 	/**
 	 * @brief Places an order, tries to match it and inserts it in the book if it is not fulfilled
 	 * @param order pointer to the order to place
+	 * @return the trades generated by the order
 	 */
 	// Trades place_order(OrderPointer& order);
 	Trades place_order(ID id, ID agengt_id, OrderType type, Price price, Volume volume);
+	/**
+	 * @brief Same as above, but appends the trades to a caller-owned buffer (no allocation once its capacity is reached)
+	 * @param trades buffer receiving the trades, it is not cleared
+	 * @return the outcome of the order (status, filled and remaining volume, number of trades, handle if it rests)
+	 */
+	PlaceResult place_order(ID id, ID agent_id, OrderType type, Price price, Volume volume, Trades& trades);
+	/**
+	 * @brief Same as above, but hands every trade to a sink as soon as it is done, without any allocation
+	 * @param sink callable invoked for each trade, in execution order
+	 * @return the outcome of the order, see above
+	 */
+	PlaceResult place_order(ID id, ID agent_id, OrderType type, Price price, Volume volume, TradeSink sink);
+	/**
+	 * @brief Places an order of any kind. LIMIT orders go through the overload above; MARKET and IOC orders trade
+	 * what they can and drop the rest, FOK orders are rejected (NOT_FILLABLE) unless the opposite levels they cross
+	 * hold their whole volume, in which case they are filled at once. These three never rest, so they are not given
+	 * a pool slot; like LIMIT orders, they are rejected (DUPLICATE_ID) if their id is the one of a resting order.
+	 * @param kind time in force of the order
+	 * @param price limit price, ignored for MARKET orders
+	 * @param sink callable invoked for each trade, in execution order
+	 * @return the outcome of the order, see above
+	 */
+	PlaceResult place_order(ID id, ID agent_id, OrderType type, OrderKind kind, Price price, Volume volume, TradeSink sink);
+	/**
+	 * @brief Same as above, but appends the trades to a caller-owned buffer
+	 * @param trades buffer receiving the trades, it is not cleared
+	 */
+	PlaceResult place_order(ID id, ID agent_id, OrderType type, OrderKind kind, Price price, Volume volume, Trades& trades);
 	/**
 	 * @brief Deletes an order in the book if it is currently active
 	 * @param id id of the order to delete
 	 */
 	void delete_order(ID id);
+	/**
+	 * @brief Deletes an order from its handle, without looking its id up
+	 * @param handle handle returned when the order was placed
+	 * @return true if the order was deleted, false if the handle is stale (order filled or already deleted)
+	 */
+	bool cancel(OrderHandle handle);
+	/**
+	 * @brief Changes the price and/or the remaining volume of a resting order without taking it out of the pool
+	 * At the same price, a smaller volume is edited in place and keeps the time priority, a larger one sends the order
+	 * to the back of its level. A new price moves the order to the new level in one go: it first matches what it
+	 * crosses there, like a new order, and the rest goes to the back of the level. A volume of 0 cancels the order.
+	 * The order keeps its id and, unless it is filled, its handle.
+	 * @param id id of the order
+	 * @param price new limit price
+	 * @param volume new remaining volume
+	 * @param sink callable invoked for each trade, in execution order
+	 * @return the outcome of the order; UNKNOWN_ORDER if it is not resting, INVALID_PRICE (order left unchanged and
+	 * still ACTIVE) for a price of 0
+	 */
+	PlaceResult amend_order(ID id, Price price, Volume volume, TradeSink sink);
+	/**
+	 * @brief Same as above, but appends the trades to a caller-owned buffer
+	 * @param trades buffer receiving the trades, it is not cleared
+	 */
+	PlaceResult amend_order(ID id, Price price, Volume volume, Trades& trades);
+	/**
+	 * @brief Same as above, from the handle of the order instead of its id
+	 * @param handle handle returned when the order was placed, UNKNOWN_ORDER if it is stale
+	 */
+	PlaceResult amend_order(OrderHandle handle, Price price, Volume volume, TradeSink sink);
+
+	/**
+	 * @brief Executes a window of commands in order, with the same effects and trades as one call per command, while
+	 * looking ahead: the ids of later cancels and amends are resolved and the limits and orders they, and later new
+	 * orders, will touch are prefetched, so that their cache misses overlap with the commands executed meanwhile.
+	 * An id resolved ahead is only used if its order is still in the same pool slot when its turn comes.
+	 * @param commands commands to execute (PLACE commands are LIMIT orders)
+	 * @param sink callable invoked for each trade, in execution order
+	 * @param results if not empty, receives the outcome of each command (it must hold at least as many entries):
+	 * the result of place_order or amend_order, DELETED for a cancel, with UNKNOWN_ORDER if the order was not resting
+	 */
+	void process_batch(std::span<const Command> commands, TradeSink sink, std::span<PlaceResult> results = {});
+
+	/**
+	 * @brief Writes every resting order to a snapshot file (see Snapshot.h), level by level in time priority, with its
+	 * agent and initial volume
+	 * @param path path of the file, replaced if it exists
+	 * @return false if the file could not be written
+	 */
+	bool save_snapshot(const std::string& path);
+	/**
+	 * @brief Loads a snapshot into an empty book: the pools and the id map are sized once, then the levels and their
+	 * orders are built directly in time priority, without going through the matching path. Handles given by the book
+	 * the snapshot was taken from do not apply; the feeds that are on receive the loaded levels and orders.
+	 * @param path path of a file written by save_snapshot
+	 * @return false if the book is not empty or the file is missing, of another version, truncated or inconsistent (a
+	 * level header out of range, level order counts not adding up to the header, an order of volume 0, an order id
+	 * appearing twice); the book is left unchanged then (orders already loaded when a late error is found are deleted
+	 * again, the feeds see both)
+	 */
+	bool load_snapshot(const std::string& path);
+
+	/**
+	 * @brief Gets every limit of one side of the book, wherever it is stored
+	 * @param type side of the book
+	 * @return the limits in ascending price order
+	 */
+	std::vector<LimitPointer> get_levels(OrderType type);
+
+	/**
+	 * @brief Gets the best levels of one side (price, total volume, number of orders). With config.depth_levels set, the
+	 * levels are kept sorted as the book changes and this is a copy of at most depth_levels entries; otherwise they are
+	 * found by walking the price structures.
+	 * @param type side of the book
+	 * @param out array receiving the levels, best first; its size is the number of levels asked for
+	 * @return the number of levels written, less than out.size() if the side has fewer levels (or than depth_levels)
+	 */
+	std::size_t get_depth(OrderType type, std::span<DepthLevel> out);
+	/**
+	 * @brief Starts or stops the L2 feed: after each command that changes levels (place, cancel, amend), the book
+	 * pushes one LevelUpdate per level it changed on the ring, with consecutive sequence numbers. When the ring is full
+	 * the update is dropped (and counted in the stats), its sequence number is still used so that the consumer sees the
+	 * gap. The consumer only sees changes made while the feed is on: start it on an empty book.
+	 * @param ring ring the book is the producer of, nullptr to stop the feed
+	 */
+	void set_level_feed(LevelRing* ring);
+	/**
+	 * @brief Starts or stops the L3 feed: every change of a resting order (see OrderEventType) is pushed on the ring
+	 * as it happens, with consecutive sequence numbers, the executions in trade order. A full ring drops the event like
+	 * for the L2 feed. Start it on an empty book, see ReplicaBook for the consumer side.
+	 * @param ring ring the book is the producer of, nullptr to stop the feed
+	 */
+	void set_order_feed(OrderEventRing* ring);
 
 	/** Getters */
 	Price get_spread();
 	double get_mid_price();
 
+	/** With a ladder or a bitmap, the trees and maps below only hold part of the levels, see get_levels */
+
 	PriceTree& get_buy_tree();
 	PriceLimitMap& get_buy_limits();
 	PriceTree& get_sell_tree();
@@ -102,11 +419,32 @@ public:
 	Price get_best_buy();
 	Price get_best_sell();
 	Orders& get_id_to_order();
+	/**
+	 * @brief Gets a resting order
+	 * @param id id of the order
+	 * @return the order, or nullptr if it is not resting in the book
+	 */
+	Order* get_order(ID id);
+	/**
+	 * @brief Gets the cold data (agent, initial volume) of a resting order
+	 * @param id id of the order
+	 * @return the data, or nullptr if the order is not resting in the book
+	 */
+	const OrderInfo* get_order_info(ID id);
+	const BookConfig& get_config() const;
+	/**
+	 * @brief Takes a snapshot of the instrumentation
+	 * @return the counters (all 0 unless compiled with ORDERBOOK_STATS) and the current gauges
+	 */
+	BookStats get_stats() const;
+	/** @brief Sets every counter back to 0 */
+	void reset_stats();
 
 	/** Print method */
 	void print();
 
 	OrderStatus get_order_status(ID i);
+	OrderStatus get_order_status(OrderHandle handle);
 };
 
 
@@ -0,0 +1,61 @@
+#ifndef ORDERBOOK_BOOKCONFIG_H
+#define ORDERBOOK_BOOKCONFIG_H
+
+#include "Types.h"
+
+/**
+ * Construction-time options of a Book. The default configuration keeps every level in the hash map + tree.
+ * The price band [band_base, band_base + band_levels * tick_size) is the range the dense structures cover,
+ * levels outside of it (or off the tick grid) always fall back to the hash map + tree.
+ */
+struct BookConfig {
+	bool use_ladder = false; /**< Stores the levels of the band in a dense tick-indexed array instead of the hash map */
+	bool use_bitmap = false; /**< Tracks the occupied ticks of the band in an occupancy bitmap instead of the tree */
+	bool queue_levels = false; /**< Keeps the orders of each limit in a contiguous FIFO with lazy cancels instead of a linked list */
+	Price band_base = 0; /**< Lowest price of the band */
+	Price tick_size = 1; /**< Price increment between two ticks of the band */
+	Length band_levels = 0; /**< Number of ticks in the band */
+
+	Length order_slab_size = 4096; /**< Number of orders allocated at once by the order pool (rounded up to a power of two) */
+	Length limit_slab_size = 512; /**< Number of limits allocated at once by the limit pool */
+	Length reserved_orders = 0; /**< Number of order slots allocated when the book is built */
+	bool prefault_pools = false; /**< Touches the pages of every new slab when it is allocated instead of on first use */
+
+	Length depth_levels = 0; /**< Best levels of each side kept sorted as the book changes, read by Book::get_depth (0: built on each call) */
+
+	/**
+	 * @brief Builds a configuration whose band covers a range around a reference price (no dense structure enabled)
+	 * @param mid reference price (center of the band)
+	 * @param band_ratio half-width of the band relative to mid (e.g. 0.08 for +/- 8%)
+	 * @param tick_size price increment between two ticks of the band
+	 * @return the corresponding configuration
+	 */
+	static BookConfig band_around(Price mid, double band_ratio, Price tick_size = 1) {
+		BookConfig config;
+		Price half_width = static_cast<Price>(mid * band_ratio);
+		config.tick_size = tick_size ? tick_size : 1;
+		config.band_base = mid > half_width ? (mid - half_width) / config.tick_size * config.tick_size : config.tick_size;
+		config.band_levels = (mid + half_width - config.band_base) / config.tick_size + 1;
+		return config;
+	}
+	/**
+	 * @brief Builds a ladder configuration covering a band around a reference price
+	 * @see band_around
+	 */
+	static BookConfig ladder_around(Price mid, double band_ratio, Price tick_size = 1) {
+		BookConfig config = band_around(mid, band_ratio, tick_size);
+		config.use_ladder = true;
+		return config;
+	}
+	/**
+	 * @brief Builds a configuration tracking the band with the occupancy bitmap, levels staying in the hash map
+	 * @see band_around
+	 */
+	static BookConfig bitmap_around(Price mid, double band_ratio, Price tick_size = 1) {
+		BookConfig config = band_around(mid, band_ratio, tick_size);
+		config.use_bitmap = true;
+		return config;
+	}
+};
+
+#endif //ORDERBOOK_BOOKCONFIG_H
@@ -0,0 +1,49 @@
+#ifndef ORDERBOOK_BOOKSTATS_H
+#define ORDERBOOK_BOOKSTATS_H
+
+#include "Types.h"
+
+/**
+ * Instrumentation of the Book internals. The counters are only maintained when the library is compiled with
+ * ORDERBOOK_STATS defined (CMake option ORDERBOOK_STATS, which defines it for every target so that Limit has the same
+ * layout everywhere): otherwise every ORDERBOOK_STAT(...) statement expands to nothing and the hot path is unchanged.
+ */
+#ifdef ORDERBOOK_STATS
+#define ORDERBOOK_STAT(...) __VA_ARGS__
+constexpr bool STATS_ENABLED = true;
+#else
+#define ORDERBOOK_STAT(...)
+constexpr bool STATS_ENABLED = false;
+#endif
+
+/** Snapshot of the Book instrumentation, see Book::get_stats */
+struct BookStats {
+	/** Counters (always 0 unless compiled with ORDERBOOK_STATS), since the book was built or reset_stats was called */
+
+	Length levels_created = 0; /**< Limits taken from the pool */
+	Length levels_destroyed = 0; /**< Limits given back to the pool */
+	Length id_lookups = 0; /**< Finds, inserts and erases in the id -> order map made by placing and cancelling orders */
+	Length id_rehashes = 0; /**< Rehashes of the id -> order map caused by an insert */
+	Length match_calls = 0; /**< Limit::match_order calls */
+	Length orders_walked = 0; /**< Queue entries visited by matching: resting orders and tombstones */
+	Length tombstones_skipped = 0; /**< Cancelled entries skipped by matching (queued limits) */
+	Length queue_compactions = 0; /**< Tombstone compactions of queued limits */
+	Length best_recomputations = 0; /**< Best price searches after the best level of a side was emptied */
+	Length duplicate_rejects = 0; /**< Orders rejected because their id is already resting */
+	Length invalid_price_rejects = 0; /**< Orders rejected because of their price */
+	Length fok_rejects = 0; /**< FOK orders rejected by the depth pre-check */
+	Length dropped_remainders = 0; /**< IOC and market orders whose unfilled volume was dropped */
+	Length level_updates_dropped = 0; /**< L2 updates not published because the feed ring was full */
+	Length order_events_dropped = 0; /**< L3 events not published because the feed ring was full */
+
+	/** Gauges, read from the structures when the snapshot is taken (available in every build) */
+
+	Length live_orders = 0; /**< Orders resting in the book */
+	Length buy_levels = 0; /**< Non-empty buy limits */
+	Length sell_levels = 0; /**< Non-empty sell limits */
+	Length order_slabs = 0; /**< Slabs allocated by the order pool, i.e. its growth events */
+	Length limit_slabs = 0; /**< Slabs allocated by the limit pool, i.e. its growth events */
+	Length id_buckets = 0; /**< Bucket count of the id -> order map */
+};
+
+#endif //ORDERBOOK_BOOKSTATS_H
@@ -0,0 +1,38 @@
+#ifndef ORDERBOOK_COMMAND_H
+#define ORDERBOOK_COMMAND_H
+
+#include <type_traits>
+#include <vector>
+#include "Types.h"
+
+enum CommandType : std::uint8_t { PLACE, CANCEL, AMEND };
+
+/**
+ * One operation of an order flow, decoded ahead of time so that replaying it only touches the book.
+ * Fields a command does not use (price, volume and side of a cancel) are left to zero.
+ * An amend gives the new price and volume of a resting order (and its side).
+ * This layout is also the record of the .lobbin binary format (see demo/Lobbin.h): fields must not be reordered.
+ */
+struct Command {
+	ID id; /**< Id of the order placed, cancelled or amended */
+	ID agent_id; /**< Agent placing the order */
+	Volume volume; /**< Volume of the order */
+	Price price; /**< Limit price of the order */
+	CommandType type; /**< Operation */
+	OrderType side; /**< Side of the order */
+	Symbol symbol; /**< Instrument of the order, used by MatchingEngine to pick the book (0 for a single book) */
+};
+
+static_assert(sizeof(Command) == 32 and std::is_trivially_copyable_v<Command>, "Commands are stored and copied in bulk");
+
+using Commands = std::vector<Command>;
+
+/** Command stamped with its position in the global order (Sequencer), also the record of a Journal */
+struct SequencedCommand {
+	std::uint64_t sequence; /**< Global sequence number, consecutive from 0 */
+	Command command; /**< Command submitted */
+};
+
+static_assert(sizeof(SequencedCommand) == 40 and std::is_trivially_copyable_v<SequencedCommand>);
+
+#endif //ORDERBOOK_COMMAND_H
@@ -0,0 +1,41 @@
+#include <algorithm>
+#include <cstring>
+#include "DepthView.h"
+
+DepthView::DepthView(OrderType side, std::size_t max_levels): max_levels(max_levels), side(side) {
+	levels.reserve(max_levels); // The view never grows past max_levels: no allocation after construction
+}
+
+void DepthView::update(Price price, Volume volume, Length count) {
+	// 视图很小且变化集中在最优几档, 线性查找比二分更快
+	std::size_t position = 0;
+	while (position < levels.size() and is_better(levels[position].price, price))
+		position++;
+	if (position < levels.size() and levels[position].price == price) {
+		levels[position].volume = volume;
+		levels[position].count = count;
+		return;
+	}
+	// 新价位: 未满时视图包含该方向全部价位, 直接插入; 已满时只有优于末档才进入视图, 并挤出末档
+	if (levels.size() == max_levels) {
+		if (position == levels.size())
+			return;
+		levels.pop_back();
+	}
+	levels.insert(levels.begin() + position, {price, volume, count});
+}
+
+bool DepthView::remove(Price price) {
+	auto it = std::find_if(levels.begin(), levels.end(), [price](const DepthLevel& level) { return level.price == price; });
+	if (it == levels.end())
+		return false;
+	bool was_full = levels.size() == max_levels;
+	levels.erase(it);
+	return was_full;
+}
+
+std::size_t DepthView::copy(std::span<DepthLevel> out) const {
+	std::size_t count = std::min(out.size(), levels.size());
+	std::memcpy(out.data(), levels.data(), count * sizeof(DepthLevel));
+	return count;
+}
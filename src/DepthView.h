@@ -0,0 +1,68 @@
+#ifndef ORDERBOOK_DEPTHVIEW_H
+#define ORDERBOOK_DEPTHVIEW_H
+
+#include <span>
+#include <vector>
+#include "Types.h"
+
+/** Aggregated state of one price level, as published in L2 market data */
+struct DepthLevel {
+	Price price; /**< Price of the level */
+	Volume volume; /**< Total remaining volume of the orders at this price */
+	Length count; /**< Number of orders at this price */
+
+	bool operator==(const DepthLevel&) const = default;
+};
+
+/**
+ * Best levels of one side of a book, best first, kept sorted as the levels change so that reading the depth is a copy.
+ * The view holds at most max_levels entries; while it is not full it holds every level of the side. The owner reports
+ * every change of a level (update) and every level that disappears (remove); when a level leaves a full view, the
+ * owner refills it with the next level of the side (push_back).
+ */
+class DepthView {
+private:
+	std::vector<DepthLevel> levels; /**< Best first, capacity reserved for max_levels entries */
+	std::size_t max_levels; /**< 0 disables the view */
+	OrderType side; /**< Side of the book, gives the sort order */
+
+	bool is_better(Price price, Price other) const { return side == BUY ? price > other : price < other; }
+
+public:
+	DepthView(): max_levels(0), side(BUY) {}
+	DepthView(OrderType side, std::size_t max_levels);
+
+	/**
+	 * @brief Reports the new volume and order count of a level, created or not
+	 * @param price price of the level
+	 * @param volume total volume of the level
+	 * @param count number of orders of the level
+	 */
+	void update(Price price, Volume volume, Length count);
+	/**
+	 * @brief Reports that a level is gone
+	 * @param price price of the level
+	 * @return true if the level was in a full view: one slot is free and the next level of the side has to be pushed
+	 */
+	bool remove(Price price);
+	/**
+	 * @brief Appends a level worse than every level of the view, to refill it after remove
+	 * @param level next level of the side
+	 */
+	void push_back(const DepthLevel& level) { levels.push_back(level); }
+	/**
+	 * @brief Copies the best levels
+	 * @param out array receiving the levels, best first
+	 * @return the number of levels copied, at most out.size()
+	 */
+	std::size_t copy(std::span<DepthLevel> out) const;
+
+	bool is_enabled() const { return max_levels > 0; }
+	bool is_empty() const { return levels.empty(); }
+	/** @brief Gets the worst level of the view, which must not be empty */
+	const DepthLevel& back() const { return levels.back(); }
+	std::span<const DepthLevel> get_levels() const { return levels; }
+	std::size_t get_max_levels() const { return max_levels; }
+};
+
+#endif //ORDERBOOK_DEPTHVIEW_H
@@ -0,0 +1,166 @@
+#ifndef ORDERBOOK_INDEXEDPOOL_H
+#define ORDERBOOK_INDEXEDPOOL_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * Fixed-size object allocator addressed by 32-bit indices instead of pointers, with O(1) allocation and release.
+ * Objects live in cache-line-aligned slabs of a power-of-two number of slots, so an index resolves with a shift and a
+ * mask. Each slot also has a cold companion (rarely read data kept out of the hot slab) and a generation that is
+ * bumped every time the slot is released, which lets callers detect indices kept after their object went away.
+ * Index 0 is never handed out and can be used as the null index.
+ * Slabs are freed without running destructors, hence objects and companions must be trivially destructible.
+ */
+template<typename T, typename Cold>
+class IndexedPool {
+	static_assert(std::is_trivially_destructible_v<T> and std::is_trivially_destructible_v<Cold>,
+			"IndexedPool frees its slabs without destroying the objects left in them");
+
+public:
+	using Index = std::uint32_t;
+	using Generation = std::uint32_t;
+	static constexpr Index NULL_INDEX = 0;
+
+private:
+	static constexpr std::size_t CACHE_LINE = 64;
+
+	/** A slot holds either an object or, when free, the index of the next free slot */
+	union Slot {
+		Index next_free;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	struct Slab {
+		Slot* slots; /**< Hot objects */
+		Cold* cold; /**< Companions, same position as their object */
+		Generation* generations; /**< Release counters, same position as their object */
+	};
+
+	std::vector<Slab> slabs; /**< Every slab allocated so far */
+	unsigned shift; /**< log2 of the number of slots per slab */
+	Index mask; /**< Number of slots per slab - 1 */
+	bool prefault; /**< Touches every page of a new slab so that page faults are not taken on the hot path */
+	Index free_head; /**< Most recently released slot */
+	Index next_unused; /**< Next never used slot, slabs are used in order */
+	std::size_t live; /**< Number of slots currently handed out */
+
+	void grow() {
+		if ((slabs.size() + 1) << shift > (std::size_t(1) << 32))
+			throw std::length_error("IndexedPool: 32-bit index space exhausted");
+		std::size_t nb_slots = std::size_t(mask) + 1;
+		std::size_t hot_bytes = (nb_slots * sizeof(Slot) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+		Slab slab{};
+		slab.slots = static_cast<Slot*>(::operator new(hot_bytes, std::align_val_t(CACHE_LINE)));
+		slab.cold = static_cast<Cold*>(::operator new(nb_slots * sizeof(Cold), std::align_val_t(alignof(Cold))));
+		slab.generations = new Generation[nb_slots]();
+		if (prefault) {
+			std::memset(static_cast<void*>(slab.slots), 0, hot_bytes);
+			std::memset(static_cast<void*>(slab.cold), 0, nb_slots * sizeof(Cold));
+		}
+		slabs.push_back(slab);
+	}
+	Slot& slot(Index index) { return slabs[index >> shift].slots[index & mask]; }
+
+public:
+	/**
+	 * @param slab_size number of slots per slab, rounded up to a power of two
+	 * @param prefault if the pages of every new slab are touched when it is allocated
+	 */
+	explicit IndexedPool(std::size_t slab_size = 4096, bool prefault = false):
+			slabs(), shift(std::countr_zero(std::bit_ceil(std::max<std::size_t>(slab_size, 2)))), mask((Index(1) << shift) - 1),
+			prefault(prefault), free_head(NULL_INDEX), next_unused(1), live(0) {}
+	IndexedPool(const IndexedPool&) = delete;
+	IndexedPool& operator=(const IndexedPool&) = delete;
+	~IndexedPool() {
+		for (Slab& slab : slabs) {
+			::operator delete(static_cast<void*>(slab.slots), std::align_val_t(CACHE_LINE));
+			::operator delete(static_cast<void*>(slab.cold), std::align_val_t(alignof(Cold)));
+			delete[] slab.generations;
+		}
+	}
+
+	/**
+	 * @brief Allocates and constructs an object
+	 * @param args arguments forwarded to the constructor of T
+	 * @return index of the new object, never NULL_INDEX (throws std::bad_alloc or std::length_error)
+	 */
+	template<typename... Args>
+	Index construct(Args&&... args) {
+		Index index;
+		if (free_head != NULL_INDEX) {
+			index = free_head;
+			free_head = slot(index).next_free;
+		} else {
+			if ((next_unused >> shift) == slabs.size())
+				grow();
+			index = next_unused++;
+		}
+		new(slot(index).storage) T(std::forward<Args>(args)...);
+		live++;
+		return index;
+	}
+	/**
+	 * @brief Destroys an object and gives its slot back to the pool, every kept index to it becomes stale
+	 * @param index index obtained from construct
+	 */
+	void destroy(Index index) {
+		Slab& slab = slabs[index >> shift];
+		slab.generations[index & mask]++;
+		slab.slots[index & mask].next_free = free_head;
+		free_head = index;
+		live--;
+	}
+	/**
+	 * @brief Allocates slabs until at least `count` objects can be handed out without growing
+	 * @param count number of objects
+	 */
+	void reserve(std::size_t count) {
+		while (get_capacity() < count + 1) // Slot 0 is never handed out
+			grow();
+	}
+
+	/**
+	 * @brief Resolves an index
+	 * @param index index of a live object
+	 * @return pointer to the object
+	 */
+	T* at(Index index) { return reinterpret_cast<T*>(slot(index).storage); }
+	/**
+	 * @brief Gets the cold companion of an object
+	 * @param index index of a live object
+	 * @return reference to the companion, uninitialized until it is first written
+	 */
+	Cold& cold(Index index) { return slabs[index >> shift].cold[index & mask]; }
+	/**
+	 * @brief Gets the current generation of a slot
+	 * @param index index of the slot
+	 * @return number of times the slot was released
+	 */
+	Generation get_generation(Index index) const { return slabs[index >> shift].generations[index & mask]; }
+	/**
+	 * @brief Tells if an index kept by a caller still refers to the object it was given for
+	 * @param index index of the slot (checked against the slots handed out so far)
+	 * @param generation generation of the slot when the index was given
+	 * @return true if the slot was not released since
+	 */
+	bool is_current(Index index, Generation generation) const {
+		return index != NULL_INDEX and index < next_unused and get_generation(index) == generation;
+	}
+
+	/** Getters */
+	std::size_t get_live() const { return live; }
+	std::size_t get_slab_count() const { return slabs.size(); }
+	std::size_t get_capacity() const { return slabs.size() << shift; }
+	std::size_t get_slab_size() const { return std::size_t(mask) + 1; }
+};
+
+#endif //ORDERBOOK_INDEXEDPOOL_H
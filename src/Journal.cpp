@@ -0,0 +1,200 @@
+#include "Journal.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define ORDERBOOK_HAS_FSYNC 1
+#elif defined(_WIN32)
+#include <io.h>
+#endif
+
+namespace {
+
+bool is_valid(const JournalHeader& header) {
+	return std::memcmp(header.magic, JournalHeader::MAGIC, sizeof(header.magic)) == 0 and header.version == JournalHeader::VERSION
+			and header.record_size == sizeof(SequencedCommand);
+}
+
+/** @brief Makes what was flushed to a file durable */
+bool sync_file(std::FILE* file) {
+#if defined(ORDERBOOK_HAS_FSYNC) && defined(__APPLE__)
+	return ::fsync(fileno(file)) == 0;
+#elif defined(ORDERBOOK_HAS_FSYNC)
+	return ::fdatasync(fileno(file)) == 0; // The size changes, the other metadata are not needed
+#elif defined(_WIN32)
+	return ::_commit(_fileno(file)) == 0;
+#else
+	return true; // No sync available: flushed to the system only
+#endif
+}
+
+/**
+ * @brief Checks an existing journal and finds its complete records
+ * @param path path of the journal
+ * @param size size of the file
+ * @param records receives the number of complete records
+ * @param next_sequence receives the sequence number following the last complete record
+ * @return false if the file could not be read or is not a journal of this version
+ */
+bool scan(const std::string& path, std::uint64_t size, std::uint64_t& records, std::uint64_t& next_sequence) {
+	std::ifstream file(path, std::ios::binary);
+	JournalHeader header;
+	if (size < sizeof(header) or not file.read(reinterpret_cast<char*>(&header), sizeof(header)) or not is_valid(header))
+		return false;
+	records = (size - sizeof(header)) / sizeof(SequencedCommand);
+	next_sequence = 0;
+	if (records == 0)
+		return true;
+	SequencedCommand last;
+	file.seekg(static_cast<std::streamoff>(sizeof(header) + (records - 1) * sizeof(SequencedCommand)));
+	if (not file.read(reinterpret_cast<char*>(&last), sizeof(last)))
+		return false;
+	next_sequence = last.sequence + 1;
+	return true;
+}
+
+} // namespace
+
+Journal::Journal(bool sync, std::chrono::microseconds idle_interval):
+		file(nullptr), sync(sync), idle_interval(idle_interval), next_sequence(0), running(false), durable(0), commits(0), failed(false) {}
+
+Journal::~Journal() {
+	stop();
+}
+
+bool Journal::open(const std::string& path) {
+	if (file)
+		return false;
+	std::error_code error;
+	std::uint64_t size = std::filesystem::exists(path, error) ? std::filesystem::file_size(path, error) : 0;
+	if (error)
+		return false;
+	std::uint64_t records = 0;
+	std::uint64_t sequence = 0;
+	if (size > 0) {
+		if (not scan(path, size, records, sequence))
+			return false;
+		// 崩溃时写了一半的末条记录直接截掉, 序号接着最后一条完整记录往下编
+		std::uint64_t complete = sizeof(JournalHeader) + records * sizeof(SequencedCommand);
+		if (complete != size) {
+			std::filesystem::resize_file(path, complete, error);
+			if (error)
+				return false;
+		}
+	}
+	std::FILE* opened = std::fopen(path.c_str(), "ab");
+	if (not opened)
+		return false;
+	if (size == 0) {
+		JournalHeader header{};
+		std::memcpy(header.magic, JournalHeader::MAGIC, sizeof(header.magic));
+		header.version = JournalHeader::VERSION;
+		header.record_size = sizeof(SequencedCommand);
+		if (std::fwrite(&header, sizeof(header), 1, opened) != 1 or std::fflush(opened) != 0) {
+			std::fclose(opened);
+			return false;
+		}
+	}
+	file = opened;
+	next_sequence = sequence;
+	durable.store(sequence, std::memory_order_release);
+	failed.store(false, std::memory_order_release);
+	return true;
+}
+
+void Journal::start() {
+	if (not file or running.exchange(true))
+		return;
+	writer = std::thread(&Journal::run, this);
+}
+
+void Journal::stop() {
+	running.store(false, std::memory_order_release);
+	if (writer.joinable())
+		writer.join();
+	if (file) {
+		std::fclose(file);
+		file = nullptr;
+	}
+}
+
+std::uint64_t Journal::append(const Command& command) {
+	std::lock_guard<std::mutex> lock(mutex);
+	pending.push_back({next_sequence, command});
+	return next_sequence++;
+}
+
+std::uint64_t Journal::append(std::span<const Command> commands) {
+	std::lock_guard<std::mutex> lock(mutex);
+	const std::uint64_t first = next_sequence;
+	for (const Command& command : commands)
+		pending.push_back({next_sequence++, command});
+	return first;
+}
+
+bool Journal::wait_durable(std::uint64_t sequence) const {
+	while (durable.load(std::memory_order_acquire) <= sequence) {
+		if (failed.load(std::memory_order_acquire))
+			return false;
+		std::this_thread::yield();
+	}
+	return true;
+}
+
+void Journal::run() {
+	std::vector<SequencedCommand> writing;
+	while (true) {
+		// 先读停止标志再取缓冲区: stop 之前追加的命令一定在这次或之前取到
+		bool stopping = not running.load(std::memory_order_acquire);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			writing.swap(pending);
+		}
+		if (writing.empty()) {
+			if (stopping)
+				return;
+			std::this_thread::sleep_for(idle_interval);
+			continue;
+		}
+		// 一次写入 + 一次落盘提交这段时间内追加的所有命令 (组提交)
+		if (not failed.load(std::memory_order_relaxed)) {
+			if (commit(writing)) {
+				durable.store(writing.back().sequence + 1, std::memory_order_release);
+				commits.fetch_add(1, std::memory_order_relaxed);
+			} else {
+				failed.store(true, std::memory_order_release);
+			}
+		}
+		writing.clear();
+	}
+}
+
+bool Journal::commit(const std::vector<SequencedCommand>& records) {
+	if (std::fwrite(records.data(), sizeof(SequencedCommand), records.size(), file) != records.size() or std::fflush(file) != 0)
+		return false;
+	return not sync or sync_file(file);
+}
+
+bool Journal::read(const std::string& path, std::vector<SequencedCommand>& records) {
+	std::FILE* file = std::fopen(path.c_str(), "rb");
+	if (not file)
+		return false;
+	JournalHeader header;
+	bool valid = std::fread(&header, sizeof(header), 1, file) == 1 and is_valid(header);
+	if (valid) {
+		// 逐块读到文件末尾, 写了一半的末条记录不计入
+		constexpr std::size_t CHUNK = 4096;
+		std::size_t count;
+		do {
+			std::size_t first = records.size();
+			records.resize(first + CHUNK);
+			count = std::fread(records.data() + first, sizeof(SequencedCommand), CHUNK, file);
+			records.resize(first + count);
+		} while (count == CHUNK);
+		valid = not std::ferror(file);
+	}
+	std::fclose(file);
+	return valid;
+}
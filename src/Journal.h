@@ -0,0 +1,119 @@
+#ifndef ORDERBOOK_JOURNAL_H
+#define ORDERBOOK_JOURNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Command.h"
+
+/**
+ * Journal file: a 32-byte JournalHeader followed by SequencedCommand records of 40 bytes (sequence number then the
+ * Command, as laid out in memory, see Command.h), little-endian, sequence numbers consecutive from 0.
+ * A record cut short by a crash is ignored when the journal is read or opened again.
+ */
+struct JournalHeader {
+	static constexpr char MAGIC[8] = {'O', 'B', 'J', 'O', 'U', 'R', 'N', 'L'};
+	static constexpr std::uint32_t VERSION = 1;
+
+	char magic[8]; /**< MAGIC */
+	std::uint32_t version; /**< VERSION */
+	std::uint32_t record_size; /**< sizeof(SequencedCommand) */
+	std::uint64_t reserved[2]; /**< 0 */
+};
+
+static_assert(sizeof(JournalHeader) == 32);
+
+/**
+ * Write-ahead journal of the input commands of a book, with group commit. The matcher thread appends each command
+ * before executing it: append only copies it into an in-memory buffer under a mutex that is never held during I/O.
+ * A background thread repeatedly swaps that buffer for an empty one, writes what it took in one call and, if enabled,
+ * makes it durable with one sync (fdatasync on POSIX, _commit on Windows, a flush only elsewhere): every command
+ * appended while a sync is in progress goes into the next one.
+ * The number of durable commands is published, so that acknowledgements can wait for it (wait_durable).
+ * Replaying the records in sequence order with the same book options gives the same book and the same trades.
+ */
+class Journal {
+private:
+	std::FILE* file; /**< Journal file opened for appending, nullptr while closed */
+	bool sync; /**< If each group commit ends with a sync to the disk */
+	std::chrono::microseconds idle_interval; /**< Sleep of the writer thread when nothing was appended */
+
+	std::mutex mutex; /**< Protects pending and next_sequence */
+	std::vector<SequencedCommand> pending; /**< Appended, not written yet */
+	std::uint64_t next_sequence; /**< Sequence number of the next appended command */
+
+	std::atomic<bool> running; /**< Cleared by stop, the writer exits once everything appended is written */
+	alignas(64) std::atomic<std::uint64_t> durable; /**< Number of commands written (and synced if enabled) */
+	std::atomic<std::uint64_t> commits; /**< Number of group commits done */
+	std::atomic<bool> failed; /**< Set by the writer thread on a write or sync error, appended commands are then no longer written */
+	std::thread writer; /**< Writer thread, not joinable while stopped */
+
+	/** @brief Loop of the writer thread */
+	void run();
+	/**
+	 * @brief Writes a group of records and syncs them if enabled (writer thread only)
+	 * @return false on an I/O error
+	 */
+	bool commit(const std::vector<SequencedCommand>& records);
+
+public:
+	/**
+	 * @param sync ends each group commit with a sync to the disk (otherwise the records only reach the page cache)
+	 * @param idle_interval sleep of the writer thread when nothing was appended since the last commit
+	 */
+	explicit Journal(bool sync = true, std::chrono::microseconds idle_interval = std::chrono::microseconds(100));
+	Journal(const Journal&) = delete;
+	Journal& operator=(const Journal&) = delete;
+	~Journal();
+
+	/**
+	 * @brief Opens a journal for appending, creating it if needed. The records of an existing journal are kept (a
+	 * torn last record is cut off) and sequence numbers continue after them.
+	 * @param path path of the journal
+	 * @return false if the file could not be opened or created, or is not a journal of this version
+	 */
+	bool open(const std::string& path);
+	/** @brief Starts the writer thread */
+	void start();
+	/** @brief Writes and syncs everything appended so far, then joins the writer thread and closes the file */
+	void stop();
+
+	/**
+	 * @brief Appends a command (matcher thread), without waiting for any I/O
+	 * @param command command about to be executed
+	 * @return the sequence number of the command
+	 */
+	std::uint64_t append(const Command& command);
+	/**
+	 * @brief Appends a window of commands at once (matcher thread)
+	 * @param commands commands about to be executed, in order
+	 * @return the sequence number of the first command
+	 */
+	std::uint64_t append(std::span<const Command> commands);
+	/**
+	 * @brief Waits until a command is durable (or the writer failed)
+	 * @param sequence sequence number returned by append
+	 * @return false if the writer failed before the command was written
+	 */
+	bool wait_durable(std::uint64_t sequence) const;
+
+	/** @brief Gets the number of commands written (and synced if enabled), i.e. the sequence number of the next one */
+	std::uint64_t get_durable() const { return durable.load(std::memory_order_acquire); }
+	std::uint64_t get_commits() const { return commits.load(std::memory_order_relaxed); }
+	bool has_failed() const { return failed.load(std::memory_order_acquire); }
+
+	/**
+	 * @brief Reads every complete record of a journal
+	 * @param path path of the journal
+	 * @param records receives the records, in file order
+	 * @return false if the file could not be read or is not a journal of this version
+	 */
+	static bool read(const std::string& path, std::vector<SequencedCommand>& records);
+};
+
+#endif //ORDERBOOK_JOURNAL_H
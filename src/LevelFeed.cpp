@@ -0,0 +1,40 @@
+#include <algorithm>
+#include "LevelFeed.h"
+
+bool LevelBook::apply(const LevelUpdate& update) {
+	bool in_sequence = update.sequence == next_sequence;
+	if (not in_sequence)
+		gaps += update.sequence - next_sequence;
+	next_sequence = update.sequence + 1;
+
+	std::unordered_map<Price, DepthLevel>& levels = update.side == BUY ? buy_levels : sell_levels;
+	if (update.count == 0)
+		levels.erase(update.price);
+	else
+		levels[update.price] = {update.price, update.volume, update.count};
+	return in_sequence;
+}
+
+std::size_t LevelBook::drain(LevelRing& ring) {
+	constexpr std::size_t BULK = 64;
+	LevelUpdate updates[BULK];
+	std::size_t total = 0;
+	while (std::size_t count = ring.try_pop_bulk(updates, BULK)) {
+		for (std::size_t i = 0; i < count; i++)
+			apply(updates[i]);
+		total += count;
+	}
+	return total;
+}
+
+std::vector<DepthLevel> LevelBook::get_levels(OrderType type) const {
+	const std::unordered_map<Price, DepthLevel>& by_price = type == BUY ? buy_levels : sell_levels;
+	std::vector<DepthLevel> levels;
+	levels.reserve(by_price.size());
+	for (const auto& [price, level] : by_price)
+		levels.push_back(level);
+	std::sort(levels.begin(), levels.end(), [type](const DepthLevel& a, const DepthLevel& b) {
+		return type == BUY ? a.price > b.price : a.price < b.price;
+	});
+	return levels;
+}
@@ -0,0 +1,60 @@
+#ifndef ORDERBOOK_LEVELFEED_H
+#define ORDERBOOK_LEVELFEED_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "DepthView.h"
+#include "SpscRing.h"
+#include "Types.h"
+
+/** New state of one price level, as published on the L2 feed of a Book (see Book::set_level_feed) */
+struct LevelUpdate {
+	std::uint64_t sequence; /**< Position in the feed of the book, consecutive from 0 */
+	Volume volume; /**< Total remaining volume at this price, 0 once the level is gone */
+	Length count; /**< Number of orders at this price, 0 once the level is gone */
+	Price price; /**< Price of the level */
+	OrderType side; /**< Side of the level */
+};
+
+using LevelRing = SpscRing<LevelUpdate>;
+
+/**
+ * Consumer side of the L2 feed: the levels of both sides rebuilt from the updates alone, which are absolute (new
+ * volume and count), so applying them in sequence order gives the levels of the book. A missing sequence number (the
+ * ring was full when the book published it) is counted as a gap; the levels may be wrong until they are rebuilt.
+ */
+class LevelBook {
+private:
+	std::unordered_map<Price, DepthLevel> buy_levels; /**< Buy levels by price, sorted only when read */
+	std::unordered_map<Price, DepthLevel> sell_levels; /**< Sell levels by price, sorted only when read */
+	std::uint64_t next_sequence; /**< Sequence number expected next */
+	Length gaps; /**< Number of updates missed */
+
+public:
+	LevelBook(): next_sequence(0), gaps(0) {}
+
+	/**
+	 * @brief Applies one update
+	 * @param update update read from the feed
+	 * @return false if updates were missed before this one
+	 */
+	bool apply(const LevelUpdate& update);
+	/**
+	 * @brief Applies every update waiting on a ring (consumer thread of the ring only)
+	 * @param ring feed of a book
+	 * @return the number of updates applied
+	 */
+	std::size_t drain(LevelRing& ring);
+
+	/**
+	 * @brief Gets the levels of one side
+	 * @param type side of the book
+	 * @return the levels, best first
+	 */
+	std::vector<DepthLevel> get_levels(OrderType type) const;
+	std::uint64_t get_next_sequence() const { return next_sequence; }
+	Length get_gaps() const { return gaps; }
+};
+
+#endif //ORDERBOOK_LEVELFEED_H
@@ -1,76 +1,114 @@
 #include <iostream>
 #include "Limit.h"
 
-void Limit::insert_order(OrderPointer order) { // Accept raw pointer
-	if (length == 0) {
-		head = tail = order;
+void Limit::insert_order(OrderIndex index) {
+	Order* order = orders->at(index);
+	if (queued) {
+		order->set_position(front_sequence + static_cast<std::uint32_t>(queue.size()));
+		queue.push_back(index);
+	} else if (length == 0) {
+		head = tail = index;
 	} else {
-		tail->set_next(order);
+		orders->at(tail)->set_next(index);
 		order->set_prev(tail);
-		tail = order;
+		tail = index;
 	}
 	total_volume += order->get_volume();
 	length++;
 }
 
-void Limit::delete_order(OrderPointer order) { // Accept raw pointer
-	if (not order) return;
+void Limit::delete_order(OrderIndex index) {
+	if (index == NO_ORDER) return;
+	Order* order = orders->at(index);
 
-	if (length == 1) { // only order in the list
-		head = nullptr; // Use nullptr for raw pointers
-		tail = nullptr;
-	} else if (order == head) { // order at head of list
+	if (queued) { // Leave a tombstone, skipped by matching and removed by compaction
+		queue[order->get_position() - front_sequence] = NO_ORDER;
+		tombstones++;
+	} else if (length == 1) { // only order in the list
+		head = NO_ORDER;
+		tail = NO_ORDER;
+	} else if (index == head) { // order at head of list
 		head = order->get_next();
-		// No reset needed for raw pointers, just set the pointer
-		if (order->get_next()) { // Check if next exists
-			order->get_next()->set_prev(nullptr);
-		}
-	} else if (order == tail) { // order at tail of list
+		orders->at(head)->set_prev(NO_ORDER);
+	} else if (index == tail) { // order at tail of list
 		tail = order->get_prev();
-		// No reset needed for raw pointers, just set the pointer
-		if (order->get_prev()) { // Check if prev exists
-			order->get_prev()->set_next(nullptr);
-		}
+		orders->at(tail)->set_next(NO_ORDER);
 	} else { // order in the list
-		order->get_prev()->set_next(order->get_next());
-		order->get_next()->set_prev(order->get_prev());
+		orders->at(order->get_prev())->set_next(order->get_next());
+		orders->at(order->get_next())->set_prev(order->get_prev());
 	}
 
-	// No reset needed for raw pointers, just clear the pointers in the deleted order
-	order->set_prev(nullptr);
-	order->set_next(nullptr);
+	// Clear the links of the deleted order
+	order->set_prev(NO_ORDER);
+	order->set_next(NO_ORDER);
 	if (order->get_status() != FULFILLED)
 		order->set_status(DELETED);
 	total_volume -= order->get_volume();
 	length--;
+	if (queued)
+		compact_queue();
 }
 
-// Note: The Book class is responsible for destroying orders now.
-// Limit::match_order should return the list of fulfilled orders to the Book.
-// However, for minimal changes now, we'll assume Book handles destruction elsewhere
-// based on the returned Trades. A better approach might involve returning fulfilled order IDs/pointers.
-Trades Limit::match_order(OrderPointer order) { // Accept raw pointer
-	Trades trades;
+void Limit::resize_order(OrderIndex index, Volume volume) {
+	Order* order = orders->at(index);
+	total_volume = total_volume - order->get_volume() + volume;
+	order->set_volume(volume);
+}
 
-	while (length > 0 and not order->is_fulfilled()) {
-		Volume fill_volume = std::min(head->get_volume(), order->get_volume());
-		head->fill(fill_volume);
-		order->fill(fill_volume);
-		total_volume -= fill_volume;
-		trades.emplace_back(order->get_id(), head->get_id(), price, fill_volume);
-		if (head->is_fulfilled()) {
-			Order* fulfilled_order = head; // Store pointer before deleting from list
-			delete_order(fulfilled_order); // Remove from this limit's list
-			// IMPORTANT: The actual destruction (calling pool.destroy())
-			// should happen in the Book class after processing trades.
-			// This function (Limit::match_order) doesn't own the pool.
-			// We rely on the caller (Book::place_order) to handle destruction.
+void Limit::compact_queue() {
+	if (length == 0) { // Nothing live left: restart from an empty queue
+		front_sequence += static_cast<std::uint32_t>(queue.size());
+		queue.clear();
+		queue_head = 0;
+		tombstones = 0;
+		return;
+	}
+	if (tombstones >= MIN_COMPACTION and tombstones > length) {
+		// Rewrite the live entries at the front, the orders learn their new position
+		ORDERBOOK_STAT(if (stats) stats->queue_compactions++;)
+		std::size_t live = 0;
+		for (std::size_t i = queue_head; i < queue.size(); i++) {
+			if (queue[i] == NO_ORDER) continue;
+			orders->at(queue[i])->set_position(front_sequence + static_cast<std::uint32_t>(live));
+			queue[live++] = queue[i];
 		}
+		queue.resize(live);
+		queue_head = 0;
+		tombstones = 0;
+	} else if (queue_head >= MIN_COMPACTION and queue_head * 2 >= queue.size()) {
+		// Drop the consumed prefix: positions are sequence numbers, the remaining orders keep theirs
+		queue.erase(queue.begin(), queue.begin() + static_cast<std::ptrdiff_t>(queue_head));
+		front_sequence += static_cast<std::uint32_t>(queue_head);
+		queue_head = 0;
 	}
+}
 
+// Note: The Book class is responsible for destroying orders now.
+// Fulfilled orders are unlinked from the list but not destroyed, the caller (Book::place_order) owns the pool.
+Trades Limit::match_order(OrderPointer order) { // Accept raw pointer
+	Trades trades;
+	match_order(order, [&trades](const Trade& trade) { trades.push_back(trade); });
 	return trades;
 }
 
+bool Limit::is_queued() const {
+	return queued;
+}
+
+std::vector<OrderIndex> Limit::take_queue() {
+	std::vector<OrderIndex> buffer = std::move(queue);
+	buffer.clear();
+	queue.clear();
+	queue_head = 0;
+	return buffer;
+}
+
+void Limit::give_queue(std::vector<OrderIndex>&& buffer) {
+	queue = std::move(buffer);
+	queue.clear();
+	queue_head = 0;
+}
+
 bool Limit::is_empty() {
 	return length == 0;
 }
@@ -81,11 +119,17 @@ Volume Limit::get_total_volume() { return total_volume; }
 
 void Limit::print() {
 	std::cout << "Limit(Price: " << price << ", Total Volume: "<< total_volume << ", #Orders: " << length << "):" << std::endl;
-	Order* curr = head; // Use raw pointer
-	while (curr) {
+	if (queued) {
+		for (std::size_t i = queue_head; i < queue.size(); i++) {
+			if (queue[i] == NO_ORDER) continue;
+			std::cout << "\t";
+			orders->at(queue[i])->print();
+		}
+		return;
+	}
+	for (OrderIndex curr = head; curr != NO_ORDER; curr = orders->at(curr)->get_next()) {
 		std::cout << "\t";
-		curr->print();
-		curr = curr->get_next();
+		orders->at(curr)->print();
 	}
 }
 
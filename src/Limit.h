@@ -2,7 +2,10 @@
 #define ORDERBOOK_LIMIT_H
 
 #include "Order.h" // Order.h now defines OrderPointer = Order*
+#include <algorithm>
 #include <functional> // Keep for cmp_limits if needed later, or remove if unused
+#include <vector>
+#include "BookStats.h"
 #include "Trade.h"
 
 class Limit {
@@ -11,28 +14,121 @@ private:
 	Length length; /**< Number of orders at this limit */
 	Volume total_volume; /**< Total volume at this limit */
 
-	OrderPointer head; /**< First order in the list (oldest) */
-	OrderPointer tail; /**< Last order in the list (most recent) */
+	OrderIndex head; /**< First order in the list (oldest) */
+	OrderIndex tail; /**< Last order in the list (most recent) */
+	OrderPool* orders; /**< Pool the indices of the list refer to */
+
+	/**
+	 * Queue mode: the orders are kept in time priority in a contiguous FIFO of pool indices instead of the linked list,
+	 * so that matching reads the next order to fill without first loading the current one.
+	 * Each order stores its queue sequence number (see Order::get_position); a cancelled order leaves a tombstone
+	 * (NO_ORDER) that matching skips, and the queue is compacted once tombstones outnumber the live orders.
+	 */
+	bool queued; /**< If the orders are in the queue rather than in the linked list */
+	std::vector<OrderIndex> queue; /**< Pool indices in time priority, NO_ORDER for a cancelled order */
+	std::size_t queue_head; /**< First entry of the queue that may still be live */
+	std::uint32_t front_sequence; /**< Sequence number of queue[0] */
+	Length tombstones; /**< Number of cancelled entries after queue_head */
+
+	ORDERBOOK_STAT(BookStats* stats = nullptr;) /**< Counters of the owning book, nullptr for a limit used on its own */
+
+	static constexpr Length MIN_COMPACTION = 32; /**< Queues shorter than this are never compacted */
+	static constexpr std::size_t PREFETCH_DISTANCE = 4; /**< Number of queue entries fetched ahead while matching */
+
+	/**
+	 * @brief Drops the consumed entries at the front of the queue and, if there are too many, the tombstones
+	 */
+	void compact_queue();
 
 public:
-	Limit(Price price): price(price), length(0), total_volume(0), head(nullptr), tail(nullptr) {}
+	Limit(Price price, OrderPool& orders, bool queued = false):
+			price(price), length(0), total_volume(0), head(NO_ORDER), tail(NO_ORDER), orders(&orders),
+			queued(queued), queue(), queue_head(0), front_sequence(0), tombstones(0) {}
 
 	/**
 	 * @brief Inserts an order at the end of the list
-	 * @param order pointer to the order to insert
+	 * @param index pool index of the order to insert
 	 */
-	void insert_order(OrderPointer order);
+	void insert_order(OrderIndex index);
 	/**
 	 * @brief Deletes an order from the limit order list. Assumes that the order is in this limit list.
-	 * @param order pointer to the order to delete
+	 * @param index pool index of the order to delete
 	 */
-	void delete_order(OrderPointer order);
+	void delete_order(OrderIndex index);
+	/**
+	 * @brief Changes the volume of an order of this limit in place, the order keeps its time priority
+	 * @param index pool index of the order
+	 * @param volume new remaining volume, not 0
+	 */
+	void resize_order(OrderIndex index, Volume volume);
 	/**
 	 * @brief Matches an opposite OrderType order to the current orders in the list
 	 * @param order order to match
 	 * @return Trades an array of trades with the matched order
 	 */
 	Trades match_order(OrderPointer order);
+	/**
+	 * @brief Matches an opposite OrderType order to the current orders in the list, without allocating
+	 * Each trade is passed to the sink once the resting order has been updated (and unlinked if fulfilled).
+	 * @param order order to match
+	 * @param on_trade callable invoked as on_trade(const Trade&) for every trade, in time priority order
+	 */
+	template<typename OnTrade>
+	void match_order(OrderPointer order, OnTrade&& on_trade);
+	/**
+	 * @brief Same as above, and hands every fulfilled resting order back right after its last trade
+	 * @param on_filled callable invoked as on_filled(OrderIndex) with the unlinked order, which it may destroy
+	 */
+	template<typename OnTrade, typename OnFilled>
+	void match_order(OrderPointer order, OnTrade&& on_trade, OnFilled&& on_filled);
+	/**
+	 * @brief Starts loading the orders that matching and inserting touch first: the first live order and, for a linked
+	 * list, the last one (a hint only, nothing is read from them)
+	 */
+	void prefetch_ends() const {
+		if (queued) {
+			if (queue_head < queue.size() and queue[queue_head] != NO_ORDER)
+				__builtin_prefetch(orders->at(queue[queue_head]), 1);
+		} else if (head != NO_ORDER) {
+			__builtin_prefetch(orders->at(head), 1);
+			__builtin_prefetch(orders->at(tail), 1);
+		}
+	}
+	/**
+	 * @brief Visits the orders of the limit in time priority
+	 * @param visit callable invoked as visit(OrderIndex) for every order, it must not change the limit
+	 */
+	template<typename Visit>
+	void for_each_order(Visit&& visit) const {
+		if (queued) {
+			for (std::size_t i = queue_head; i < queue.size(); i++)
+				if (queue[i] != NO_ORDER)
+					visit(queue[i]);
+			return;
+		}
+		for (OrderIndex curr = head; curr != NO_ORDER; curr = orders->at(curr)->get_next())
+			visit(curr);
+	}
+	/**
+	 * @brief Checks if the orders are kept in the queue rather than in the linked list
+	 * @return true in queue mode
+	 */
+	bool is_queued() const;
+	/**
+	 * @brief Takes the queue buffer of an empty limit, so that its capacity can be reused by another limit
+	 * @return the (empty) buffer
+	 */
+	std::vector<OrderIndex> take_queue();
+	/**
+	 * @brief Gives a spare buffer to an empty queued limit
+	 * @param buffer buffer taken from another limit
+	 */
+	void give_queue(std::vector<OrderIndex>&& buffer);
+	/**
+	 * @brief Gives the counters matching updates (no-op unless compiled with ORDERBOOK_STATS)
+	 * @param book_stats counters of the owning book
+	 */
+	void set_stats([[maybe_unused]] BookStats* book_stats) { ORDERBOOK_STAT(stats = book_stats;) }
 	/**
 	 * @brief Checks if the limit is empty (i.e. no orders)
 	 * @return true if there are no order false otherwise
@@ -51,4 +147,56 @@ public:
 class Limit; // Forward declaration
 using LimitPointer = Limit*; // Use raw pointer
 
+template<typename OnTrade>
+void Limit::match_order(OrderPointer order, OnTrade&& on_trade) {
+	match_order(order, on_trade, [](OrderIndex) {});
+}
+
+template<typename OnTrade, typename OnFilled>
+void Limit::match_order(OrderPointer order, OnTrade&& on_trade, OnFilled&& on_filled) {
+	ORDERBOOK_STAT(if (stats) stats->match_calls++;)
+	if (queued) {
+		while (length > 0 and not order->is_fulfilled()) {
+			OrderIndex resting_index = queue[queue_head];
+			ORDERBOOK_STAT(if (stats) stats->orders_walked++;)
+			if (resting_index == NO_ORDER) { // Cancelled order
+				ORDERBOOK_STAT(if (stats) stats->tombstones_skipped++;)
+				queue_head++;
+				tombstones--;
+				continue;
+			}
+			// The next orders are known without loading this one: start fetching them now
+			if (queue_head + PREFETCH_DISTANCE < queue.size() and queue[queue_head + PREFETCH_DISTANCE] != NO_ORDER)
+				__builtin_prefetch(orders->at(queue[queue_head + PREFETCH_DISTANCE]), 1);
+			Order* resting = orders->at(resting_index);
+			Volume fill_volume = std::min(resting->get_volume(), order->get_volume());
+			resting->fill(fill_volume);
+			order->fill(fill_volume);
+			total_volume -= fill_volume;
+			on_trade(Trade(order->get_id(), resting->get_id(), price, fill_volume));
+			if (resting->is_fulfilled()) {
+				queue_head++;
+				length--;
+				on_filled(resting_index);
+			}
+		}
+		compact_queue();
+		return;
+	}
+	while (length > 0 and not order->is_fulfilled()) {
+		OrderIndex resting_index = head;
+		ORDERBOOK_STAT(if (stats) stats->orders_walked++;)
+		Order* resting = orders->at(resting_index);
+		Volume fill_volume = std::min(resting->get_volume(), order->get_volume());
+		resting->fill(fill_volume);
+		order->fill(fill_volume);
+		total_volume -= fill_volume;
+		on_trade(Trade(order->get_id(), resting->get_id(), price, fill_volume));
+		if (resting->is_fulfilled()) {
+			delete_order(resting_index); // Unlinked only: the Book owns the pool
+			on_filled(resting_index);
+		}
+	}
+}
+
 #endif //ORDERBOOK_LIMIT_H
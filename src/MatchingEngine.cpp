@@ -0,0 +1,106 @@
+#include "MatchingEngine.h"
+#include "ThreadUtils.h"
+
+MatchingEngine::MatchingEngine(const EngineConfig& config): config(config), workers(), running(false) {
+	std::size_t nb_workers = config.nb_workers ? config.nb_workers : 1;
+	workers.reserve(nb_workers);
+	for (std::size_t i = 0; i < nb_workers; i++)
+		workers.push_back(std::make_unique<Worker>(config.ring_capacity, config.publish_trades));
+}
+
+MatchingEngine::~MatchingEngine() {
+	stop();
+}
+
+void MatchingEngine::start() {
+	if (running.exchange(true))
+		return;
+	for (std::size_t i = 0; i < workers.size(); i++) {
+		unsigned core = static_cast<unsigned>(config.first_core + i);
+		workers[i]->thread = std::thread(&MatchingEngine::run, this, std::ref(*workers[i]), core);
+	}
+}
+
+void MatchingEngine::stop() {
+	running.store(false, std::memory_order_release);
+	for (auto& worker : workers)
+		if (worker->thread.joinable())
+			worker->thread.join();
+}
+
+void MatchingEngine::run(Worker& worker, unsigned core) {
+	if (config.pin_threads)
+		pin_current_thread(core);
+	Command batch[BATCH_SIZE];
+	while (true) {
+		std::size_t count = worker.commands.try_pop_bulk(batch, BATCH_SIZE);
+		if (count) {
+			execute(worker, std::span<const Command>(batch, count));
+			continue;
+		}
+		// 停止后还要把已提交的命令执行完: 先读标志再确认队列为空
+		if (not running.load(std::memory_order_acquire) and worker.commands.is_empty())
+			return;
+		cpu_relax();
+	}
+}
+
+void MatchingEngine::execute(Worker& worker, std::span<const Command> commands) {
+	PlaceResult results[BATCH_SIZE];
+	std::size_t first = 0;
+	while (first < commands.size()) {
+		// 同一品种的连续命令一次交给订单簿
+		const Symbol symbol = commands[first].symbol;
+		std::size_t last = first + 1;
+		while (last < commands.size() and commands[last].symbol == symbol)
+			last++;
+
+		// 订单簿由工作线程自己创建, 内存页首先在其所在核心上被访问
+		std::unique_ptr<Book>& book = worker.books[symbol];
+		if (not book)
+			book = std::make_unique<Book>(config.book_config);
+		std::span<const Command> run = commands.subspan(first, last - first);
+		// 成交在撮合时即推送, 早于本批命令的结果
+		auto on_trade = [this, &worker, symbol](const Trade& trade) {
+			if (config.publish_trades)
+				publish(worker.trades, EngineTrade{symbol, trade.get_incoming_order(), trade.get_matched_order(), trade.get_price(),
+						trade.get_volume()}, worker.dropped_trades);
+		};
+		book->process_batch(run, on_trade, std::span<PlaceResult>(results, run.size()));
+
+		if (config.publish_results)
+			for (std::size_t i = 0; i < run.size(); i++)
+				publish(worker.results, EngineResult{run[i].id, symbol, run[i].type, results[i]}, worker.dropped_results);
+		first = last;
+	}
+}
+
+template<typename T>
+void MatchingEngine::publish(SpscRing<T>& ring, const T& value, std::atomic<std::uint64_t>& dropped) {
+	while (not ring.try_push(value)) {
+		// 停止后不再等消费者腾出空间: 放不下的输出丢弃并计数, 否则 stop 会一直等下去
+		if (not running.load(std::memory_order_acquire)) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		cpu_relax();
+	}
+}
+
+bool MatchingEngine::submit(const Command& command) {
+	return workers[worker_of(command.symbol)]->commands.try_push(command);
+}
+
+std::size_t MatchingEngine::poll_results(std::size_t worker, EngineResult* out, std::size_t max) {
+	return workers[worker]->results.try_pop_bulk(out, max);
+}
+
+std::size_t MatchingEngine::poll_trades(std::size_t worker, EngineTrade* out, std::size_t max) {
+	return workers[worker]->trades.try_pop_bulk(out, max);
+}
+
+Book* MatchingEngine::get_book(Symbol symbol) {
+	auto& books = workers[worker_of(symbol)]->books;
+	auto it = books.find(symbol);
+	return it != books.end() ? it->second.get() : nullptr;
+}
@@ -0,0 +1,156 @@
+#ifndef ORDERBOOK_MATCHINGENGINE_H
+#define ORDERBOOK_MATCHINGENGINE_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Book.h"
+#include "Command.h"
+#include "SpscRing.h"
+
+/** Outcome of one command executed by a MatchingEngine worker */
+struct EngineResult {
+	ID id; /**< Id of the order the command was for */
+	Symbol symbol; /**< Instrument of the command */
+	CommandType type; /**< Operation of the command */
+	PlaceResult result; /**< Outcome, as given by Book::process_batch */
+};
+
+/** Trade done by a MatchingEngine worker, in execution order for its worker */
+struct EngineTrade {
+	Symbol symbol; /**< Instrument of the book the trade was done in */
+	ID incoming_order; /**< Order that came in (see Trade) */
+	ID matched_order; /**< Resting order it matched */
+	Price price; /**< Price of the trade */
+	Volume volume; /**< Volume traded */
+};
+
+/** Construction-time options of a MatchingEngine */
+struct EngineConfig {
+	std::size_t nb_workers = 1; /**< Number of worker threads, each owning the books of its symbols */
+	std::size_t ring_capacity = 1 << 16; /**< Capacity of each command and result ring (rounded up to a power of two) */
+	bool publish_results = true; /**< Pushes an EngineResult per command on the result ring of its worker */
+	bool publish_trades = true; /**< Pushes an EngineTrade per trade on the trade ring of its worker, before the result of the command */
+	bool pin_threads = true; /**< Pins worker i to core (first_core + i) modulo the number of cores (Linux only) */
+	unsigned first_core = 0; /**< Core of the first worker when pinning */
+	BookConfig book_config; /**< Options of every book */
+};
+
+/**
+ * Multi-instrument front of the books. Symbols are partitioned across worker threads (symbol modulo the number of
+ * workers) and every book is only ever touched by the thread of its worker, so books need no locking.
+ * One producer thread submits the commands: each one goes through the lock-free command ring of the worker of its
+ * symbol, which busy-polls it and executes the commands in order with Book::process_batch. The outcome of every
+ * command goes back on a result ring per worker, and its trades on a trade ring per worker, both read by one consumer
+ * thread (possibly the producer itself). A command's trades are pushed before its result: a consumer that polls the
+ * trades after the result of a command has all of them.
+ * A worker waits for room on its output rings, so the consumer has to keep draining the ones that are enabled; once the
+ * engine is stopped, an output that does not fit is dropped and counted instead (get_dropped_results,
+ * get_dropped_trades), so that stop and the destructor never wait for a consumer.
+ */
+class MatchingEngine {
+private:
+	/** Rings and books of a worker thread, allocated separately so that workers share no cache line */
+	struct Worker {
+		SpscRing<Command> commands; /**< Commands submitted for the symbols of this worker */
+		SpscRing<EngineResult> results; /**< Outcomes of the executed commands */
+		SpscRing<EngineTrade> trades; /**< Trades of the executed commands */
+		std::unordered_map<Symbol, std::unique_ptr<Book>> books; /**< Books of the symbols seen so far, created by the worker thread */
+		std::thread thread; /**< Worker thread, not joinable while the engine is stopped */
+		std::atomic<std::uint64_t> dropped_results; /**< Results that found the ring full after stop */
+		std::atomic<std::uint64_t> dropped_trades; /**< Trades that found the ring full after stop */
+
+		explicit Worker(std::size_t ring_capacity, bool with_trades):
+				commands(ring_capacity), results(ring_capacity), trades(with_trades ? ring_capacity : 1), dropped_results(0), dropped_trades(0) {}
+	};
+
+	static constexpr std::size_t BATCH_SIZE = 64; /**< Commands taken from the ring and executed at once */
+
+	EngineConfig config; /**< Options the engine was built with */
+	std::vector<std::unique_ptr<Worker>> workers; /**< One per thread */
+	std::atomic<bool> running; /**< Cleared by stop, workers exit once their command ring is empty */
+
+	/**
+	 * @brief Loop of a worker thread: polls its command ring until the engine is stopped and the ring drained
+	 * @param worker state of the worker
+	 * @param core core the thread is pinned to, if pinning is enabled
+	 */
+	void run(Worker& worker, unsigned core);
+	/**
+	 * @brief Executes commands popped from a ring, grouping the consecutive ones of a same symbol in one batch
+	 * @param worker state of the worker
+	 * @param commands commands to execute
+	 */
+	void execute(Worker& worker, std::span<const Command> commands);
+	/**
+	 * @brief Pushes an output of a worker, waiting for room while the engine runs and dropping it once stopped
+	 * @param ring result or trade ring of the worker
+	 * @param value output to push
+	 * @param dropped counter incremented when the output is dropped
+	 */
+	template<typename T>
+	void publish(SpscRing<T>& ring, const T& value, std::atomic<std::uint64_t>& dropped);
+
+public:
+	explicit MatchingEngine(const EngineConfig& config = EngineConfig());
+	MatchingEngine(const MatchingEngine&) = delete;
+	MatchingEngine& operator=(const MatchingEngine&) = delete;
+	~MatchingEngine();
+
+	/** @brief Starts the worker threads */
+	void start();
+	/**
+	 * @brief Lets every worker finish the commands already submitted, then joins the threads
+	 * Results published from then on are dropped if their ring is full: drain the rings first to get all of them.
+	 */
+	void stop();
+
+	/**
+	 * @brief Hands a command to the worker of its symbol (producer thread only)
+	 * @param command command to execute, its symbol selects the book
+	 * @return false if the command ring of the worker is full, the command is not taken then
+	 */
+	bool submit(const Command& command);
+	/**
+	 * @brief Takes the results published by a worker (consumer thread only)
+	 * @param worker index of the worker
+	 * @param out array receiving the results, in execution order
+	 * @param max size of out
+	 * @return the number of results taken
+	 */
+	std::size_t poll_results(std::size_t worker, EngineResult* out, std::size_t max);
+	/**
+	 * @brief Takes the trades published by a worker (consumer thread only)
+	 * @param worker index of the worker
+	 * @param out array receiving the trades, in execution order
+	 * @param max size of out
+	 * @return the number of trades taken
+	 */
+	std::size_t poll_trades(std::size_t worker, EngineTrade* out, std::size_t max);
+
+	/**
+	 * @brief Gets the worker in charge of a symbol
+	 * @param symbol instrument
+	 * @return index of the worker
+	 */
+	std::size_t worker_of(Symbol symbol) const { return symbol % workers.size(); }
+	/**
+	 * @brief Gets the book of a symbol, only while the engine is stopped
+	 * @param symbol instrument
+	 * @return the book, or nullptr if no command was ever submitted for this symbol
+	 */
+	Book* get_book(Symbol symbol);
+	std::size_t get_nb_workers() const { return workers.size(); }
+	/**
+	 * @brief Gets the number of results a worker dropped because its result ring was full after stop
+	 * @param worker index of the worker
+	 */
+	std::uint64_t get_dropped_results(std::size_t worker) const { return workers[worker]->dropped_results.load(std::memory_order_relaxed); }
+	/** @brief Same as above, for the trades */
+	std::uint64_t get_dropped_trades(std::size_t worker) const { return workers[worker]->dropped_trades.load(std::memory_order_relaxed); }
+	const EngineConfig& get_config() const { return config; }
+};
+
+#endif //ORDERBOOK_MATCHINGENGINE_H
@@ -0,0 +1,100 @@
+#ifndef ORDERBOOK_MPSCRING_H
+#define ORDERBOOK_MPSCRING_H
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include "ThreadUtils.h"
+
+/**
+ * Bounded lock-free queue from any number of producer threads to one consumer thread, in the style of the disruptor.
+ * A producer claims the next sequence number with a single fetch_add, which fixes the position of its element in the
+ * global order, waits until the consumer has freed the slot of that sequence (one lap earlier), writes the element and
+ * publishes it by stamping the slot. The consumer reads the slots strictly in sequence order: a claimed but not yet
+ * published slot holds back the ones after it, so the elements come out exactly in claim order.
+ * Slots are a cache line each, so that producers writing neighbouring sequences do not share lines.
+ */
+template<typename T>
+class MpscRing {
+private:
+	static_assert(std::is_trivially_copyable_v<T>, "Slots are copied in and out");
+	static constexpr std::size_t CACHE_LINE = 64;
+	static constexpr unsigned MAX_SPINS = 256; /**< Pauses of a producer waiting on a full ring before it starts yielding */
+
+	/** Slot of sequence s: stamp == s while free for s, s + 1 once s is published, s + capacity once consumed */
+	struct alignas(CACHE_LINE) Slot {
+		std::atomic<std::uint64_t> stamp;
+		T value;
+	};
+
+	alignas(CACHE_LINE) std::atomic<std::uint64_t> claimed; /**< Next sequence to claim, shared by the producers */
+	alignas(CACHE_LINE) std::uint64_t next; /**< Next sequence to consume, owned by the consumer */
+	std::uint64_t mask; /**< Capacity - 1 */
+	std::unique_ptr<Slot[]> slots;
+
+public:
+	/**
+	 * @param capacity minimum number of elements the ring holds, rounded up to a power of two
+	 */
+	explicit MpscRing(std::size_t capacity):
+			claimed(0), next(0), mask(std::bit_ceil(capacity ? capacity : 1) - 1), slots(std::make_unique<Slot[]>(mask + 1)) {
+		for (std::uint64_t i = 0; i <= mask; i++)
+			slots[i].stamp.store(i, std::memory_order_relaxed);
+	}
+	MpscRing(const MpscRing&) = delete;
+	MpscRing& operator=(const MpscRing&) = delete;
+
+	/**
+	 * @brief Claims the next sequence number and publishes an element there, spinning while the ring is full (any thread)
+	 * @param fill callable invoked as fill(T&, sequence) to write the element in its slot
+	 * @return the sequence number of the element
+	 */
+	template<typename Fill>
+	std::uint64_t publish(Fill&& fill) {
+		const std::uint64_t sequence = claimed.fetch_add(1, std::memory_order_relaxed);
+		Slot& slot = slots[sequence & mask];
+		// The consumer has not freed this slot yet, the ring is full: spin a little, then give the core away
+		for (unsigned spins = 0; slot.stamp.load(std::memory_order_acquire) != sequence; spins++) {
+			if (spins < MAX_SPINS)
+				cpu_relax();
+			else
+				std::this_thread::yield();
+		}
+		fill(slot.value, sequence);
+		slot.stamp.store(sequence + 1, std::memory_order_release);
+		return sequence;
+	}
+	/**
+	 * @brief Takes up to max elements in sequence order, stopping at the first unpublished one (consumer thread only)
+	 * @param out array receiving the elements
+	 * @param max size of out
+	 * @return the number of elements taken
+	 */
+	std::size_t try_pop_bulk(T* out, std::size_t max) {
+		std::size_t count = 0;
+		for (; count < max; count++) {
+			Slot& slot = slots[(next + count) & mask];
+			if (slot.stamp.load(std::memory_order_acquire) != next + count + 1)
+				break;
+			out[count] = slot.value;
+			slot.stamp.store(next + count + mask + 1, std::memory_order_release); // Free for the next lap
+		}
+		next += count;
+		return count;
+	}
+
+	/**
+	 * @brief Gets the sequence number the consumer will read next (consumer thread only)
+	 * @return number of elements consumed so far
+	 */
+	std::uint64_t get_next() const { return next; }
+	/**
+	 * @brief Gets the number of sequence numbers claimed so far, published or not
+	 */
+	std::uint64_t get_claimed() const { return claimed.load(std::memory_order_acquire); }
+	std::size_t get_capacity() const { return mask + 1; }
+};
+
+#endif //ORDERBOOK_MPSCRING_H
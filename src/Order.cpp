@@ -13,24 +13,25 @@ bool Order::is_fulfilled() {
 }
 
 ID Order::get_id() const { return id; }
-ID Order::get_agent_id() const { return agent_id; }
 OrderType Order::get_type() const { return type; }
 Price Order::get_price() const { return price; }
+void Order::set_price(Price price) { this->price = price; }
 Volume Order::get_volume() { return volume; }
+void Order::set_volume(Volume volume) { this->volume = volume; }
 OrderStatus Order::get_status() { return status; }
 void Order::set_status(OrderStatus status) { this->status = status; }
-Order* Order::get_prev() { return prev; } // Return raw pointer
-void Order::set_prev(Order* prev) { this->prev = prev; } // Accept raw pointer
-Order* Order::get_next() { return next; } // Return raw pointer
-void Order::set_next(Order* next) { this->next = next; } // Accept raw pointer
+OrderIndex Order::get_prev() const { return prev; }
+void Order::set_prev(OrderIndex prev) { this->prev = prev; }
+OrderIndex Order::get_next() const { return next; }
+void Order::set_next(OrderIndex next) { this->next = next; }
+std::uint32_t Order::get_position() const { return prev; } // Queued limits do not link their orders
+void Order::set_position(std::uint32_t position) { prev = position; }
 
 void Order::print() {
 	std::cout <<
 		"Order(ID: " << id <<
-		", Agent ID: " << agent_id <<
 		", Type: " << (type == BUY ? "BUY" : "SELL") <<
 		", Price: " << price <<
-		", Initial volume: " << initial_volume <<
 		", Volume: " << volume <<
 		", Status: " << (status == ACTIVE ? "ACTIVE" : (status == FULFILLED ? "FULFILLED" : "DELETED")) <<
 		")" <<
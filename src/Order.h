@@ -1,28 +1,33 @@
 #ifndef ORDERBOOK_ORDER_H
 #define ORDERBOOK_ORDER_H
 
+#include "IndexedPool.h"
 #include "Types.h"
 
 class Order; // Forward declaration
 using OrderPointer = Order*; // Use raw pointer
 
+/**
+ * Hot part of an order, the one read by the matching loop: 32 bytes, so that two orders share a cache line.
+ * Orders live in an IndexedPool and are linked by 32-bit pool indices (NO_ORDER for none) instead of pointers.
+ * Data that matching never reads is kept in the OrderInfo companion of the same pool slot.
+ */
 class Order {
 private:
 	ID id; /**< Order id */
-	ID agent_id; /**< id of the agent who placed the order */
-	OrderType type; /**< Order type (buy/sell) */
-	Price price; /**< Limit price of the order */
-	Volume initial_volume; /**< Initial volume/number of shares in the order */
 	Volume volume; /**< Volume/number of remaining shares in the order */
-	OrderStatus status;  /**< Current status of the order */
 
 	/** As orders are stored in a doubly-linked list, each order stores its previous and next orders */
-	Order* prev; /**< Previous order in the list */
-	Order* next; /**< Next order in the list */
+	OrderIndex next; /**< Next order in the list */
+	OrderIndex prev; /**< Previous order in the list, or position in the queue of a queued limit (see Limit) */
+
+	Price price; /**< Limit price of the order */
+	OrderType type; /**< Order type (buy/sell) */
+	OrderStatus status;  /**< Current status of the order */
 
 public:
-	Order(ID id, ID agent_id, OrderType type, Price price, Volume volume):
-			id(id), agent_id(agent_id), type(type), price(price), initial_volume(volume), volume(volume), status(ACTIVE), prev(nullptr), next(nullptr) {}
+	Order(ID id, OrderType type, Price price, Volume volume):
+			id(id), volume(volume), next(NO_ORDER), prev(NO_ORDER), price(price), type(type), status(ACTIVE) {}
 
 	/**
 	 * @brief fills the order with a given volume (quantity)
@@ -37,21 +42,37 @@ public:
 
 	/** Getters and setters */
 	ID get_id() const;
-	ID get_agent_id() const;
 	OrderType get_type() const;
 	Price get_price() const;
+	void set_price(Price price);
 	Volume get_volume();
+	void set_volume(Volume volume);
 	OrderStatus get_status();
 	void set_status(OrderStatus status);
-	Order* get_prev(); // Return raw pointer
-	void set_prev(Order* prev); // Accept raw pointer
-	Order* get_next(); // Return raw pointer
-	void set_next(Order* next); // Accept raw pointer
+	OrderIndex get_prev() const;
+	void set_prev(OrderIndex prev);
+	OrderIndex get_next() const;
+	void set_next(OrderIndex next);
+	std::uint32_t get_position() const;
+	void set_position(std::uint32_t position);
 
 	/** Print method */
 	void print();
 };
 
+static_assert(sizeof(Order) == 32, "Order must stay half a cache line");
+
+/**
+ * Cold part of an order, stored next to it in the pool but outside of the hot slab
+ */
+struct OrderInfo {
+	ID agent_id; /**< id of the agent who placed the order */
+	Volume initial_volume; /**< Initial volume/number of shares in the order */
+};
+
+using OrderPool = IndexedPool<Order, OrderInfo>;
+static_assert(OrderPool::NULL_INDEX == NO_ORDER);
+
 // using OrderPointer = Order*; // Replaced by alias at line 7
 
 #endif //ORDERBOOK_ORDER_H
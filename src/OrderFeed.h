@@ -0,0 +1,29 @@
+#ifndef ORDERBOOK_ORDERFEED_H
+#define ORDERBOOK_ORDERFEED_H
+
+#include <cstdint>
+#include "SpscRing.h"
+#include "Types.h"
+
+/**
+ * Kind of an L3 event. A resting order appears with ADD_ORDER, loses volume in place with MODIFY_ORDER (amend to a
+ * smaller volume, time priority kept) or EXECUTE_ORDER (filled by an incoming order), and leaves the book with
+ * DELETE_ORDER (cancel) or its last EXECUTE_ORDER. An amend that loses the time priority (larger volume, new price) is a
+ * DELETE_ORDER followed, if the order rests again, by an ADD_ORDER with the same id.
+ */
+enum OrderEventType : std::uint8_t { ADD_ORDER, MODIFY_ORDER, EXECUTE_ORDER, DELETE_ORDER };
+
+/** Change of one resting order, as published on the L3 feed of a Book (see Book::set_order_feed) */
+struct OrderEvent {
+	std::uint64_t sequence; /**< Position in the feed of the book, consecutive from 0 */
+	ID id; /**< Id of the resting order */
+	ID incoming_id; /**< EXECUTE_ORDER: id of the incoming order (Trade::get_incoming_order), 0 otherwise */
+	Volume volume; /**< ADD_ORDER and MODIFY_ORDER: new remaining volume, EXECUTE_ORDER: traded volume, DELETE_ORDER: volume removed */
+	Price price; /**< Price of the order (the trade price for EXECUTE_ORDER) */
+	OrderEventType type; /**< Kind of change */
+	OrderType side; /**< Side of the resting order */
+};
+
+using OrderEventRing = SpscRing<OrderEvent>;
+
+#endif //ORDERBOOK_ORDERFEED_H
@@ -0,0 +1,23 @@
+#ifndef ORDERBOOK_ORDERHANDLE_H
+#define ORDERBOOK_ORDERHANDLE_H
+
+#include "Types.h"
+
+/**
+ * Opaque reference to a resting order: index of its slot in the book's order pool plus the generation of that slot.
+ * A slot's generation changes every time its order leaves the book, so a handle kept after its order was filled or
+ * cancelled is detected as stale instead of reaching whatever order reused the slot.
+ */
+struct OrderHandle {
+	OrderIndex index = NO_ORDER; /**< Slot in the order pool, NO_ORDER if the order did not rest */
+	std::uint32_t generation = 0; /**< Generation of the slot when the handle was given */
+
+	/**
+	 * @brief Tells if the handle was given for a resting order (it may have gone stale since)
+	 * @return false for the handle of an order that never rested
+	 */
+	bool is_valid() const { return index != NO_ORDER; }
+	bool operator==(const OrderHandle&) const = default;
+};
+
+#endif //ORDERBOOK_ORDERHANDLE_H
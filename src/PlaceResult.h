@@ -0,0 +1,35 @@
+#ifndef ORDERBOOK_PLACERESULT_H
+#define ORDERBOOK_PLACERESULT_H
+
+#include "OrderHandle.h"
+
+/** Why the book refused an order or an amend (UNKNOWN_ORDER: the amended order is not resting), nothing traded */
+enum RejectReason : std::uint8_t {NOT_REJECTED, INVALID_PRICE, DUPLICATE_ID, NOT_FILLABLE, UNKNOWN_ORDER};
+
+/**
+ * Outcome of placing (or amending) an order, filled in as the order goes through the book so that callers
+ * do not have to look the order up again to know what happened to it.
+ */
+struct PlaceResult {
+	OrderStatus status = DELETED; /**< ACTIVE if the order rests, FULFILLED if it was fully matched, DELETED if it was rejected or if what was left of it was dropped (IOC and market orders) */
+	Volume filled = 0; /**< Volume matched on arrival */
+	Volume remaining = 0; /**< Volume left resting in the book */
+	Length fills = 0; /**< Number of trades generated */
+	RejectReason reject_reason = NOT_REJECTED; /**< Set when the order was refused, NOT_FILLABLE for a FOK order the book did not have the volume for */
+	OrderHandle handle; /**< Handle of the order if it rests in the book, an invalid handle otherwise */
+
+	/**
+	 * @brief Result of an order or an amend the book refused
+	 * @param reason why it was refused
+	 */
+	static PlaceResult rejected(RejectReason reason) {
+		PlaceResult result;
+		result.reject_reason = reason;
+		return result;
+	}
+
+	bool is_resting() const { return status == ACTIVE; }
+	bool is_rejected() const { return reject_reason != NOT_REJECTED; }
+};
+
+#endif //ORDERBOOK_PLACERESULT_H
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <bit>
+#include "PriceBitmap.h"
+
+PriceBitmap::PriceBitmap(Price base, Price tick, Length size): base(base), tick(tick ? tick : 1), size(size), levels() {
+	if (size == 0) return;
+	std::size_t bits = size;
+	do {
+		std::size_t words = (bits + 63) / 64;
+		levels.emplace_back(words, 0);
+		bits = words;
+	} while (bits > 1);
+}
+
+void PriceBitmap::set_index(std::size_t index) {
+	for (auto& level : levels) {
+		Word& word = level[index / 64];
+		bool was_empty = word == 0;
+		word |= Word(1) << (index % 64);
+		if (not was_empty) return; // Upper levels already know this word is occupied
+		index /= 64;
+	}
+}
+
+void PriceBitmap::clear_index(std::size_t index) {
+	for (auto& level : levels) {
+		Word& word = level[index / 64];
+		word &= ~(Word(1) << (index % 64));
+		if (word != 0) return; // Word still occupied: upper levels unchanged
+		index /= 64;
+	}
+}
+
+std::size_t PriceBitmap::find_prev(std::size_t index) const {
+	std::size_t level = 0;
+	// Climb until a word has a set bit at or below the position
+	while (true) {
+		std::size_t word_index = index / 64;
+		Word bits = levels[level][word_index] & (~Word(0) >> (63 - index % 64));
+		if (bits) {
+			index = word_index * 64 + 63 - std::countl_zero(bits);
+			break;
+		}
+		if (word_index == 0 or level + 1 == levels.size()) return NOT_FOUND;
+		level++;
+		index = word_index - 1;
+	}
+	// Go back down following the highest set bit
+	while (level > 0) {
+		level--;
+		index = index * 64 + 63 - std::countl_zero(levels[level][index]);
+	}
+	return index;
+}
+
+std::size_t PriceBitmap::find_next(std::size_t index) const {
+	std::size_t level = 0;
+	// Climb until a word has a set bit at or above the position
+	while (true) {
+		std::size_t word_index = index / 64;
+		if (word_index >= levels[level].size()) return NOT_FOUND;
+		Word bits = levels[level][word_index] & (~Word(0) << (index % 64));
+		if (bits) {
+			index = word_index * 64 + std::countr_zero(bits);
+			break;
+		}
+		if (level + 1 == levels.size()) return NOT_FOUND;
+		level++;
+		index = word_index + 1;
+	}
+	// Go back down following the lowest set bit
+	while (level > 0) {
+		level--;
+		index = index * 64 + std::countr_zero(levels[level][index]);
+	}
+	return index;
+}
+
+bool PriceBitmap::test(Price price) const {
+	std::size_t index = (price - base) / tick;
+	return levels[0][index / 64] >> (index % 64) & 1;
+}
+
+Price PriceBitmap::find_highest_at_or_below(Price price) const {
+	if (is_empty() or price < base) return 0;
+	std::size_t index = std::min<std::size_t>((price - base) / tick, size - 1);
+	std::size_t found = find_prev(index);
+	return found == NOT_FOUND ? 0 : base + static_cast<Price>(found) * tick;
+}
+
+Price PriceBitmap::find_lowest_at_or_above(Price price) const {
+	if (is_empty()) return 0;
+	std::size_t index = price <= base ? 0 : (static_cast<std::size_t>(price) - base + tick - 1) / tick;
+	if (index >= size) return 0;
+	std::size_t found = find_next(index);
+	return found == NOT_FOUND ? 0 : base + static_cast<Price>(found) * tick;
+}
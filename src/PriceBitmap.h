@@ -0,0 +1,79 @@
+#ifndef ORDERBOOK_PRICEBITMAP_H
+#define ORDERBOOK_PRICEBITMAP_H
+
+#include <cstdint>
+#include <vector>
+#include "Types.h"
+
+/**
+ * Hierarchical 64-ary occupancy bitmap over the ticks of a bounded price band.
+ * Level 0 has one bit per tick, each bit of level n + 1 tells whether the corresponding word of level n is non-zero.
+ * Finding the next occupied tick in either direction takes at most two tzcnt/lzcnt per level (3 levels cover 262144 ticks).
+ * Prices outside the band or off the tick grid are not covered and must be tracked elsewhere by the caller.
+ */
+class PriceBitmap {
+private:
+	using Word = std::uint64_t;
+
+	Price base; /**< Price of the first tick */
+	Price tick; /**< Price increment between two consecutive ticks */
+	Length size; /**< Number of ticks covered */
+	std::vector<std::vector<Word>> levels; /**< levels[0] holds one bit per tick, the last level is a single word */
+
+	static constexpr std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+
+	void set_index(std::size_t index);
+	void clear_index(std::size_t index);
+	std::size_t find_prev(std::size_t index) const;
+	std::size_t find_next(std::size_t index) const;
+
+public:
+	PriceBitmap(): base(0), tick(1), size(0), levels() {}
+	PriceBitmap(Price base, Price tick, Length size);
+
+	/**
+	 * @brief Checks if a price has a bit in the bitmap (inside the band and on the tick grid)
+	 * @param price price to check
+	 * @return true if the price is covered by the bitmap false otherwise
+	 */
+	bool covers(Price price) const {
+		if (price < base) return false;
+		Price offset = price - base;
+		return offset % tick == 0 and offset / tick < size;
+	}
+	/**
+	 * @brief Marks a covered price as occupied
+	 * @param price price of the level, must be covered by the bitmap
+	 */
+	void set(Price price) { set_index((price - base) / tick); }
+	/**
+	 * @brief Marks a covered price as empty
+	 * @param price price of the level, must be covered by the bitmap
+	 */
+	void clear(Price price) { clear_index((price - base) / tick); }
+	/**
+	 * @brief Checks if a covered price is marked as occupied
+	 * @param price price of the level, must be covered by the bitmap
+	 * @return true if the bit of this price is set
+	 */
+	bool test(Price price) const;
+	/**
+	 * @brief Finds the highest occupied price at or below a price
+	 * @param price upper bound of the search
+	 * @return the price found, 0 if there is none
+	 */
+	Price find_highest_at_or_below(Price price) const;
+	/**
+	 * @brief Finds the lowest occupied price at or above a price
+	 * @param price lower bound of the search
+	 * @return the price found, 0 if there is none
+	 */
+	Price find_lowest_at_or_above(Price price) const;
+
+	/** Getters */
+	bool is_enabled() const { return size > 0; }
+	bool is_empty() const { return size == 0 or levels.back()[0] == 0; }
+	Length get_size() const { return size; }
+};
+
+#endif //ORDERBOOK_PRICEBITMAP_H
@@ -0,0 +1,39 @@
+#include <algorithm>
+#include "PriceLadder.h"
+
+void PriceLadder::set(Price price, LimitPointer limit) {
+	LimitPointer& slot = slots[(price - base) / tick];
+	if (not slot) count++;
+	slot = limit;
+}
+
+void PriceLadder::clear(Price price) {
+	LimitPointer& slot = slots[(price - base) / tick];
+	if (slot) count--;
+	slot = nullptr;
+}
+
+Price PriceLadder::find_highest_at_or_below(Price price) const {
+	if (count == 0 or price < base) return 0;
+	std::size_t index = std::min<std::size_t>((price - base) / tick, slots.size() - 1);
+	for (std::size_t i = index + 1; i-- > 0;) {
+		if (slots[i]) return base + static_cast<Price>(i) * tick;
+	}
+	return 0;
+}
+
+Price PriceLadder::find_lowest_at_or_above(Price price) const {
+	if (count == 0) return 0;
+	std::size_t index = price <= base ? 0 : (static_cast<std::size_t>(price) - base + tick - 1) / tick;
+	for (std::size_t i = index; i < slots.size(); i++) {
+		if (slots[i]) return base + static_cast<Price>(i) * tick;
+	}
+	return 0;
+}
+
+void PriceLadder::collect(std::vector<LimitPointer>& out) const {
+	if (count == 0) return;
+	for (LimitPointer limit : slots) {
+		if (limit) out.push_back(limit);
+	}
+}
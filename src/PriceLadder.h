@@ -0,0 +1,76 @@
+#ifndef ORDERBOOK_PRICELADDER_H
+#define ORDERBOOK_PRICELADDER_H
+
+#include <vector>
+#include "Limit.h"
+
+/**
+ * Dense, tick-indexed array of limits covering a bounded price band.
+ * The slot of a price is (price - base) / tick, so a lookup is a subtraction, a division and one load.
+ * Prices outside the band or off the tick grid are not covered and must be stored elsewhere by the caller.
+ */
+class PriceLadder {
+private:
+	Price base; /**< Price of the first slot */
+	Price tick; /**< Price increment between two consecutive slots */
+	std::vector<LimitPointer> slots; /**< One limit pointer per tick, nullptr when the level is empty */
+	Length count; /**< Number of non-empty slots */
+
+public:
+	PriceLadder(): base(0), tick(1), slots(), count(0) {}
+	PriceLadder(Price base, Price tick, Length levels): base(base), tick(tick ? tick : 1), slots(levels, nullptr), count(0) {}
+
+	/**
+	 * @brief Checks if a price has a slot in the ladder (inside the band and on the tick grid)
+	 * @param price price to check
+	 * @return true if the price is covered by the ladder false otherwise
+	 */
+	bool covers(Price price) const {
+		if (price < base) return false;
+		Price offset = price - base;
+		return offset % tick == 0 and offset / tick < slots.size();
+	}
+	/**
+	 * @brief Gets the limit stored at a covered price
+	 * @param price price of the limit, must be covered by the ladder
+	 * @return the limit at this price or nullptr if there is none
+	 */
+	LimitPointer get(Price price) const { return slots[(price - base) / tick]; }
+	/**
+	 * @brief Stores a limit at a covered price
+	 * @param price price of the limit, must be covered by the ladder
+	 * @param limit limit to store, must not be nullptr
+	 */
+	void set(Price price, LimitPointer limit);
+	/**
+	 * @brief Removes the limit stored at a covered price
+	 * @param price price of the limit, must be covered by the ladder
+	 */
+	void clear(Price price);
+	/**
+	 * @brief Finds the highest non-empty level at or below a price
+	 * @param price upper bound of the search
+	 * @return the price of the level found, 0 if there is none
+	 */
+	Price find_highest_at_or_below(Price price) const;
+	/**
+	 * @brief Finds the lowest non-empty level at or above a price
+	 * @param price lower bound of the search
+	 * @return the price of the level found, 0 if there is none
+	 */
+	Price find_lowest_at_or_above(Price price) const;
+	/**
+	 * @brief Appends every non-empty level of the ladder to a vector, in ascending price order
+	 * @param out vector receiving the limits
+	 */
+	void collect(std::vector<LimitPointer>& out) const;
+
+	/** Getters */
+	bool is_enabled() const { return not slots.empty(); }
+	Price get_base() const { return base; }
+	Price get_tick() const { return tick; }
+	Length get_size() const { return slots.size(); }
+	Length get_count() const { return count; }
+};
+
+#endif //ORDERBOOK_PRICELADDER_H
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include "ReplicaBook.h"
+
+ReplicaBook::ReplicaBook(std::size_t reserved_orders): next_sequence(0), gaps(0) {
+	order_pool.reserve(reserved_orders);
+	id_to_order.reserve(reserved_orders);
+}
+
+ReplicaBook::~ReplicaBook() {
+	// Same as Book: the limit pool does not track live objects (orders are freed with their pool)
+	for (auto& [price, limit] : buy_limits)
+		limit_pool.destroy(limit);
+	for (auto& [price, limit] : sell_limits)
+		limit_pool.destroy(limit);
+}
+
+bool ReplicaBook::apply(const OrderEvent& event) {
+	bool in_sequence = event.sequence == next_sequence;
+	if (not in_sequence)
+		gaps += event.sequence - next_sequence;
+	next_sequence = event.sequence + 1;
+
+	std::unordered_map<Price, LimitPointer>& limits = event.side == BUY ? buy_limits : sell_limits;
+	if (event.type == ADD_ORDER) {
+		auto [it, inserted] = id_to_order.try_emplace(event.id, NO_ORDER);
+		if (not inserted)
+			return in_sequence;
+		it->second = order_pool.construct(event.id, event.side, event.price, event.volume);
+		LimitPointer& limit = limits[event.price];
+		if (not limit)
+			limit = limit_pool.construct(event.price, order_pool);
+		limit->insert_order(it->second);
+		return in_sequence;
+	}
+
+	auto it = id_to_order.find(event.id);
+	if (it == id_to_order.end())
+		return in_sequence;
+	OrderIndex index = it->second;
+	Order* order = order_pool.at(index);
+	// 成交量不小于剩余量 (或撤单) 时订单离开订单簿, 否则原地减量, 保留时间优先级
+	Volume remaining = event.type == MODIFY_ORDER ? event.volume
+			: event.type == EXECUTE_ORDER and event.volume < order->get_volume() ? order->get_volume() - event.volume : 0;
+	if (remaining == 0)
+		remove(index);
+	else
+		limits[order->get_price()]->resize_order(index, remaining);
+	return in_sequence;
+}
+
+void ReplicaBook::remove(OrderIndex index) {
+	Order* order = order_pool.at(index);
+	std::unordered_map<Price, LimitPointer>& limits = order->get_type() == BUY ? buy_limits : sell_limits;
+	auto level = limits.find(order->get_price());
+	level->second->delete_order(index);
+	if (level->second->is_empty()) {
+		limit_pool.destroy(level->second);
+		limits.erase(level);
+	}
+	id_to_order.erase(order->get_id());
+	order_pool.destroy(index);
+}
+
+std::size_t ReplicaBook::drain(OrderEventRing& ring) {
+	constexpr std::size_t BULK = 64;
+	OrderEvent events[BULK];
+	std::size_t total = 0;
+	while (std::size_t count = ring.try_pop_bulk(events, BULK)) {
+		for (std::size_t i = 0; i < count; i++)
+			apply(events[i]);
+		total += count;
+	}
+	return total;
+}
+
+Order* ReplicaBook::get_order(ID id) {
+	auto it = id_to_order.find(id);
+	return it != id_to_order.end() ? order_pool.at(it->second) : nullptr;
+}
+
+std::vector<DepthLevel> ReplicaBook::get_levels(OrderType type) {
+	std::vector<DepthLevel> levels;
+	for (auto& [price, limit] : type == BUY ? buy_limits : sell_limits)
+		levels.push_back({price, limit->get_total_volume(), limit->get_length()});
+	std::sort(levels.begin(), levels.end(), [type](const DepthLevel& a, const DepthLevel& b) {
+		return type == BUY ? a.price > b.price : a.price < b.price;
+	});
+	return levels;
+}
@@ -0,0 +1,73 @@
+#ifndef ORDERBOOK_REPLICABOOK_H
+#define ORDERBOOK_REPLICABOOK_H
+
+#include <unordered_map>
+#include <vector>
+#include "DepthView.h"
+#include "Limit.h"
+#include "OrderFeed.h"
+#include "SlabPool.h"
+
+/**
+ * Read-only copy of a Book rebuilt from its L3 feed: every event edits one resting order, nothing is ever matched, so
+ * applying a feed is much cheaper than replaying the commands that produced it. Orders and levels use the same pool
+ * and Limit lists as the Book: the orders of each level are kept in time priority, in the order of their ADD_ORDER.
+ * A missing sequence number (the ring was full when the book published it) is counted as a gap; events for orders the
+ * replica does not know are ignored, the replica may be wrong until it is rebuilt.
+ */
+class ReplicaBook {
+private:
+	OrderPool order_pool; /**< Resting orders */
+	SlabPool<Limit> limit_pool; /**< Levels */
+	std::unordered_map<ID, OrderIndex> id_to_order; /**< Maps the ids to the pool index of the resting orders */
+	std::unordered_map<Price, LimitPointer> buy_limits; /**< Buy levels by price */
+	std::unordered_map<Price, LimitPointer> sell_limits; /**< Sell levels by price */
+	std::uint64_t next_sequence; /**< Sequence number expected next */
+	Length gaps; /**< Number of events missed */
+
+	/**
+	 * @brief Takes a resting order out of its level (removing the level if it is empty) and out of the replica
+	 * @param index pool index of the order
+	 */
+	void remove(OrderIndex index);
+
+public:
+	/**
+	 * @param reserved_orders number of orders the pool and the id map hold before they have to grow
+	 */
+	explicit ReplicaBook(std::size_t reserved_orders = 0);
+	ReplicaBook(const ReplicaBook&) = delete;
+	ReplicaBook& operator=(const ReplicaBook&) = delete;
+	~ReplicaBook();
+
+	/**
+	 * @brief Applies one event
+	 * @param event event read from the feed
+	 * @return false if events were missed before this one
+	 */
+	bool apply(const OrderEvent& event);
+	/**
+	 * @brief Applies every event waiting on a ring (consumer thread of the ring only)
+	 * @param ring feed of a book
+	 * @return the number of events applied
+	 */
+	std::size_t drain(OrderEventRing& ring);
+
+	/**
+	 * @brief Gets a resting order
+	 * @param id id of the order
+	 * @return the order, or nullptr if it is not resting
+	 */
+	Order* get_order(ID id);
+	/**
+	 * @brief Gets the levels of one side
+	 * @param type side of the book
+	 * @return the levels, best first
+	 */
+	std::vector<DepthLevel> get_levels(OrderType type);
+	Length get_nb_orders() const { return id_to_order.size(); }
+	std::uint64_t get_next_sequence() const { return next_sequence; }
+	Length get_gaps() const { return gaps; }
+};
+
+#endif //ORDERBOOK_REPLICABOOK_H
@@ -0,0 +1,64 @@
+#include "Sequencer.h"
+#include "ThreadUtils.h"
+
+Sequencer::Sequencer(Book& book, std::size_t capacity, BatchListener listener):
+		book(book), ring(capacity), listener(std::move(listener)), running(false), executed(0) {}
+
+Sequencer::~Sequencer() {
+	stop();
+}
+
+void Sequencer::start(bool pin, unsigned core) {
+	if (running.exchange(true))
+		return;
+	matcher = std::thread(&Sequencer::run, this, pin, core);
+}
+
+void Sequencer::stop() {
+	running.store(false, std::memory_order_release);
+	if (matcher.joinable())
+		matcher.join();
+}
+
+std::uint64_t Sequencer::submit(const Command& command) {
+	return ring.publish([&command](SequencedCommand& slot, std::uint64_t sequence) {
+		slot.sequence = sequence;
+		slot.command = command;
+	});
+}
+
+void Sequencer::wait_for(std::uint64_t sequence) const {
+	while (executed.load(std::memory_order_acquire) <= sequence)
+		cpu_relax();
+}
+
+void Sequencer::run(bool pin, unsigned core) {
+	if (pin)
+		pin_current_thread(core);
+	SequencedCommand batch[BATCH_SIZE];
+	Command commands[BATCH_SIZE];
+	PlaceResult results[BATCH_SIZE];
+	Trades trades; // Reused from batch to batch: no allocation once it is large enough
+	auto on_trade = [&trades](const Trade& trade) { trades.push_back(trade); };
+	while (true) {
+		std::size_t count = ring.try_pop_bulk(batch, BATCH_SIZE);
+		if (count) {
+			for (std::size_t i = 0; i < count; i++)
+				commands[i] = batch[i].command;
+			if (listener) {
+				trades.clear();
+				book.process_batch(std::span<const Command>(commands, count), on_trade, std::span<PlaceResult>(results, count));
+				listener(std::span<const SequencedCommand>(batch, count), std::span<const PlaceResult>(results, count), trades);
+			} else {
+				// 没有监听者时成交无人接收, 不必收集
+				book.process_batch(std::span<const Command>(commands, count), [](const Trade&) {}, std::span<PlaceResult>(results, count));
+			}
+			executed.store(ring.get_next(), std::memory_order_release);
+			continue;
+		}
+		// 停止时, 已领取序号的命令 (可能尚未发布完) 全部执行后才退出
+		if (not running.load(std::memory_order_acquire) and ring.get_next() == ring.get_claimed())
+			return;
+		cpu_relax();
+	}
+}
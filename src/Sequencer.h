@@ -0,0 +1,82 @@
+#ifndef ORDERBOOK_SEQUENCER_H
+#define ORDERBOOK_SEQUENCER_H
+
+#include <atomic>
+#include <functional>
+#include <span>
+#include <thread>
+#include "Book.h"
+#include "Command.h"
+#include "MpscRing.h"
+
+/**
+ * Single entry point of a Book for several threads. Each submitting thread claims a global sequence number on a
+ * lock-free multi-producer ring (see MpscRing) and returns as soon as its command is published; one matcher thread
+ * busy-polls the ring and applies the commands to the book in sequence order with Book::process_batch.
+ * The book must not be used by anyone else while the sequencer runs. What the commands did, trades included, is only
+ * reported to the listener: without one, the trades are dropped.
+ */
+class Sequencer {
+public:
+	/**
+	 * Called by the matcher thread after each batch, with the commands, their outcome (see Book::process_batch) and the
+	 * trades of the batch in execution order: the first results[0].fills trades are those of the first command, the next
+	 * results[1].fills those of the second one, and so on. The spans are only valid during the call.
+	 */
+	using BatchListener = std::function<void(std::span<const SequencedCommand>, std::span<const PlaceResult>, std::span<const Trade>)>;
+
+private:
+	static constexpr std::size_t BATCH_SIZE = 64; /**< Commands taken from the ring and executed at once */
+
+	Book& book; /**< Book the commands are applied to */
+	MpscRing<SequencedCommand> ring; /**< Submitted commands, in sequence order */
+	BatchListener listener; /**< Optional, called after each batch */
+	std::atomic<bool> running; /**< Cleared by stop, the matcher exits once every claimed command is executed */
+	alignas(64) std::atomic<std::uint64_t> executed; /**< Number of commands executed, written by the matcher */
+	std::thread matcher; /**< Matcher thread, not joinable while stopped */
+
+	/**
+	 * @brief Loop of the matcher thread
+	 * @param pin if the thread pins itself to core
+	 * @param core core of the matcher thread
+	 */
+	void run(bool pin, unsigned core);
+
+public:
+	/**
+	 * @param book book the commands are applied to
+	 * @param capacity number of commands the ring holds (rounded up to a power of two), submit spins while it is full
+	 * @param listener if set, called by the matcher thread after each batch with its outcome and trades
+	 */
+	explicit Sequencer(Book& book, std::size_t capacity = 1 << 16, BatchListener listener = nullptr);
+	Sequencer(const Sequencer&) = delete;
+	Sequencer& operator=(const Sequencer&) = delete;
+	~Sequencer();
+
+	/**
+	 * @brief Starts the matcher thread
+	 * @param pin pins the matcher thread to core (Linux only)
+	 * @param core core of the matcher thread
+	 */
+	void start(bool pin = false, unsigned core = 0);
+	/** @brief Lets the matcher execute every command submitted so far, then joins it */
+	void stop();
+
+	/**
+	 * @brief Submits a command (any thread)
+	 * @param command command to execute
+	 * @return the sequence number stamped on the command
+	 */
+	std::uint64_t submit(const Command& command);
+	/**
+	 * @brief Spins until a command was executed
+	 * @param sequence sequence number returned by submit
+	 */
+	void wait_for(std::uint64_t sequence) const;
+	/**
+	 * @brief Gets the number of commands executed so far, i.e. the sequence number of the next one
+	 */
+	std::uint64_t get_executed() const { return executed.load(std::memory_order_acquire); }
+};
+
+#endif //ORDERBOOK_SEQUENCER_H
@@ -0,0 +1,135 @@
+#ifndef ORDERBOOK_SLABPOOL_H
+#define ORDERBOOK_SLABPOOL_H
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * Fixed-size object allocator with O(1) allocation and release.
+ * Memory is obtained in cache-line-aligned slabs of `slab_size` objects that are never returned before the pool dies.
+ * Released slots go on an intrusive LIFO free list (the link is stored in the slot itself), so unlike
+ * boost::object_pool::free (ordered_free, linear in the free list length) releasing does not depend on the pool size.
+ * The pool does not track live objects: whoever owns them must destroy them before the pool goes away.
+ */
+template<typename T>
+class SlabPool {
+private:
+	static constexpr std::size_t CACHE_LINE = 64;
+
+	/** A slot holds either an object or, when free, the link to the next free slot */
+	union Slot {
+		Slot* next_free;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	std::vector<Slot*> slabs; /**< Every slab allocated so far */
+	std::size_t slab_size; /**< Number of slots per slab */
+	bool prefault; /**< Touches every page of a new slab so that page faults are not taken on the hot path */
+	Slot* free_list; /**< Most recently released slot */
+	Slot* next_unused; /**< Next never used slot of the last slab */
+	Slot* slab_end; /**< End of the last slab */
+	std::size_t live; /**< Number of slots currently handed out */
+
+	void grow() {
+		std::size_t bytes = (slab_size * sizeof(Slot) + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+		Slot* slab = static_cast<Slot*>(::operator new(bytes, std::align_val_t(CACHE_LINE)));
+		if (prefault)
+			std::memset(static_cast<void*>(slab), 0, bytes);
+		slabs.push_back(slab);
+		next_unused = slab;
+		slab_end = slab + slab_size;
+	}
+
+public:
+	explicit SlabPool(std::size_t slab_size = 4096, bool prefault = false):
+			slabs(), slab_size(slab_size ? slab_size : 1), prefault(prefault), free_list(nullptr), next_unused(nullptr), slab_end(nullptr), live(0) {}
+	SlabPool(const SlabPool&) = delete;
+	SlabPool& operator=(const SlabPool&) = delete;
+	~SlabPool() {
+		for (Slot* slab : slabs)
+			::operator delete(static_cast<void*>(slab), std::align_val_t(CACHE_LINE));
+	}
+
+	/**
+	 * @brief Gets uninitialized memory for one object
+	 * @return pointer to the memory, never nullptr (throws std::bad_alloc)
+	 */
+	T* allocate() {
+		Slot* slot;
+		if (free_list) {
+			slot = free_list;
+			free_list = slot->next_free;
+		} else {
+			if (next_unused == slab_end)
+				grow();
+			slot = next_unused++;
+		}
+		live++;
+		return reinterpret_cast<T*>(slot->storage);
+	}
+	/**
+	 * @brief Gives the memory of an object back to the pool, without calling its destructor
+	 * @param object pointer obtained from allocate
+	 */
+	void release(T* object) {
+		Slot* slot = reinterpret_cast<Slot*>(object);
+		slot->next_free = free_list;
+		free_list = slot;
+		live--;
+	}
+	/**
+	 * @brief Allocates and constructs an object
+	 * @param args arguments forwarded to the constructor of T
+	 * @return pointer to the new object
+	 */
+	template<typename... Args>
+	T* construct(Args&&... args) {
+		T* object = allocate();
+		try {
+			return new(object) T(std::forward<Args>(args)...);
+		} catch (...) {
+			release(object);
+			throw;
+		}
+	}
+	/**
+	 * @brief Destroys an object and gives its memory back to the pool
+	 * @param object pointer obtained from construct
+	 */
+	void destroy(T* object) {
+		object->~T();
+		release(object);
+	}
+	/**
+	 * @brief Allocates slabs until at least `count` objects can be handed out without growing
+	 * @param count number of objects
+	 */
+	void reserve(std::size_t count) {
+		std::size_t capacity = slabs.size() * slab_size;
+		if (count <= capacity) return;
+		std::size_t missing = (count - capacity + slab_size - 1) / slab_size;
+		// Keep the current slab as the bump region: new slabs are only threaded on the free list
+		for (std::size_t i = 0; i < missing; i++) {
+			Slot* bump = next_unused;
+			Slot* end = slab_end;
+			grow();
+			for (Slot* slot = slab_end; slot-- != next_unused;) {
+				slot->next_free = free_list;
+				free_list = slot;
+			}
+			next_unused = bump;
+			slab_end = end;
+		}
+	}
+
+	/** Getters */
+	std::size_t get_live() const { return live; }
+	std::size_t get_slab_count() const { return slabs.size(); }
+	std::size_t get_capacity() const { return slabs.size() * slab_size; }
+	std::size_t get_slab_size() const { return slab_size; }
+};
+
+#endif //ORDERBOOK_SLABPOOL_H
@@ -0,0 +1,52 @@
+#ifndef ORDERBOOK_SNAPSHOT_H
+#define ORDERBOOK_SNAPSHOT_H
+
+#include <bit>
+#include <cstdint>
+#include "Types.h"
+
+/**
+ * Snapshot file of a Book (see Book::save_snapshot): fixed-width, little-endian records.
+ * A 32-byte SnapshotHeader is followed by `nb_levels` level blocks, the buy levels from the best one then the sell
+ * levels from the best one. Each block is a 16-byte SnapshotLevel followed by the `nb_orders` 32-byte SnapshotOrder
+ * records of the level, in time priority:
+ *
+ *   SnapshotLevel                     SnapshotOrder
+ *   offset  size  field               offset  size  field
+ *        0     4  price                    0     8  id
+ *        4     1  side (0 BUY, 1 SELL)     8     8  agent_id
+ *        5     3  reserved (0)            16     8  volume (remaining)
+ *        8     8  nb_orders               24     8  initial_volume
+ *
+ * The file size is therefore known from the header alone, which is how truncated files are told apart.
+ */
+static_assert(std::endian::native == std::endian::little, "Records are copied as laid out in memory");
+
+struct SnapshotHeader {
+	static constexpr char MAGIC[8] = {'O', 'B', 'S', 'N', 'A', 'P', '\0', '\0'};
+	static constexpr std::uint32_t VERSION = 1;
+
+	char magic[8]; /**< MAGIC */
+	std::uint32_t version; /**< VERSION */
+	std::uint32_t reserved; /**< 0 */
+	std::uint64_t nb_levels; /**< Number of level blocks */
+	std::uint64_t nb_orders; /**< Number of order records, all levels together */
+};
+
+struct SnapshotLevel {
+	Price price; /**< Price of the level */
+	OrderType side; /**< Side of the level */
+	std::uint8_t reserved[3]; /**< 0 */
+	std::uint64_t nb_orders; /**< Number of order records following */
+};
+
+struct SnapshotOrder {
+	ID id; /**< Id of the order */
+	ID agent_id; /**< Agent of the order (OrderInfo) */
+	Volume volume; /**< Remaining volume */
+	Volume initial_volume; /**< Volume the order was placed with (OrderInfo) */
+};
+
+static_assert(sizeof(SnapshotHeader) == 32 and sizeof(SnapshotLevel) == 16 and sizeof(SnapshotOrder) == 32);
+
+#endif //ORDERBOOK_SNAPSHOT_H
@@ -0,0 +1,98 @@
+#ifndef ORDERBOOK_SPSCRING_H
+#define ORDERBOOK_SPSCRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Bounded lock-free queue between exactly one producer thread and one consumer thread.
+ * The capacity is a power of two so that positions wrap with a mask. Each side owns one counter (tail for the
+ * producer, head for the consumer) on its own cache line and keeps a private copy of the other side's counter, which
+ * it only reloads when the ring looks full (producer) or empty (consumer): in steady state a push or a pop touches no
+ * cache line written by the other thread except the slot itself.
+ */
+template<typename T>
+class SpscRing {
+private:
+	static_assert(std::is_trivially_copyable_v<T>, "Slots are copied in and out");
+	static constexpr std::size_t CACHE_LINE = 64;
+
+	alignas(CACHE_LINE) std::atomic<std::size_t> head; /**< Next position to pop, written by the consumer */
+	std::size_t cached_tail; /**< Consumer copy of tail */
+	alignas(CACHE_LINE) std::atomic<std::size_t> tail; /**< Next position to push, written by the producer */
+	std::size_t cached_head; /**< Producer copy of head */
+	alignas(CACHE_LINE) std::size_t mask; /**< Capacity - 1 */
+	std::vector<T> slots;
+
+public:
+	/**
+	 * @param capacity minimum number of elements the ring holds, rounded up to a power of two
+	 */
+	explicit SpscRing(std::size_t capacity):
+			head(0), cached_tail(0), tail(0), cached_head(0), mask(std::bit_ceil(capacity ? capacity : 1) - 1), slots(mask + 1) {}
+	SpscRing(const SpscRing&) = delete;
+	SpscRing& operator=(const SpscRing&) = delete;
+
+	/**
+	 * @brief Appends an element (producer thread only)
+	 * @param value element to copy in
+	 * @return false if the ring is full, nothing is pushed then
+	 */
+	bool try_push(const T& value) {
+		const std::size_t position = tail.load(std::memory_order_relaxed);
+		if (position - cached_head > mask) {
+			cached_head = head.load(std::memory_order_acquire);
+			if (position - cached_head > mask)
+				return false;
+		}
+		slots[position & mask] = value;
+		tail.store(position + 1, std::memory_order_release);
+		return true;
+	}
+	/**
+	 * @brief Takes the oldest element (consumer thread only)
+	 * @param value receives the element
+	 * @return false if the ring is empty
+	 */
+	bool try_pop(T& value) {
+		const std::size_t position = head.load(std::memory_order_relaxed);
+		if (position == cached_tail) {
+			cached_tail = tail.load(std::memory_order_acquire);
+			if (position == cached_tail)
+				return false;
+		}
+		value = slots[position & mask];
+		head.store(position + 1, std::memory_order_release);
+		return true;
+	}
+	/**
+	 * @brief Takes up to max of the oldest elements at once, publishing the new head a single time (consumer thread only)
+	 * @param out array receiving the elements
+	 * @param max size of out
+	 * @return the number of elements taken, 0 if the ring is empty
+	 */
+	std::size_t try_pop_bulk(T* out, std::size_t max) {
+		const std::size_t position = head.load(std::memory_order_relaxed);
+		if (cached_tail - position < max)
+			cached_tail = tail.load(std::memory_order_acquire);
+		const std::size_t count = std::min(max, cached_tail - position);
+		for (std::size_t i = 0; i < count; i++)
+			out[i] = slots[(position + i) & mask];
+		if (count)
+			head.store(position + count, std::memory_order_release);
+		return count;
+	}
+
+	/**
+	 * @brief Tells if the ring is empty, exact only when called by the consumer
+	 * @return true if there is nothing to pop
+	 */
+	bool is_empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+	std::size_t get_capacity() const { return mask + 1; }
+};
+
+#endif //ORDERBOOK_SPSCRING_H
@@ -0,0 +1,33 @@
+#ifndef ORDERBOOK_THREADUTILS_H
+#define ORDERBOOK_THREADUTILS_H
+
+#include <algorithm>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+/** @brief Hint to the core that the calling thread is spinning on a shared location */
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#endif
+}
+
+/**
+ * @brief Pins the calling thread to a core (Linux only, no-op elsewhere)
+ * @param core index of the core, taken modulo the number of cores
+ * @return true if the thread was pinned
+ */
+inline bool pin_current_thread(unsigned core) {
+#ifdef __linux__
+	cpu_set_t cores;
+	CPU_ZERO(&cores);
+	CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &cores);
+	return pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores) == 0;
+#else
+	return false;
+#endif
+}
+
+#endif //ORDERBOOK_THREADUTILS_H
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <iostream>
+#include <memory>
+#include <type_traits>
 #include "Types.h"
 
 class Trade {
@@ -30,4 +32,23 @@ public:
 
 using Trades = std::vector<Trade>;
 
+/**
+ * Non-owning reference to a callable receiving the trades one by one, e.g. a lambda `[&](const Trade& trade) {...}`.
+ * It is two pointers wide and never allocates: the callable must outlive the call the sink is passed to.
+ */
+class TradeSink {
+private:
+	void* context; /**< Address of the callable */
+	void (*callback)(void*, const Trade&); /**< Calls the callable stored at context */
+
+public:
+	template<typename F>
+	requires (not std::is_same_v<std::remove_cvref_t<F>, TradeSink>) and std::is_invocable_v<F&, const Trade&>
+	TradeSink(F&& f):
+		context(const_cast<void*>(static_cast<const void*>(std::addressof(f)))),
+		callback([](void* context, const Trade& trade) { (*static_cast<std::remove_reference_t<F>*>(context))(trade); }) {}
+
+	void operator()(const Trade& trade) const { callback(context, trade); }
+};
+
 #endif //ORDERBOOK_TRADE_H
@@ -8,9 +8,19 @@ using ID = std::uint64_t;
 using Price = std::uint32_t;
 using Volume = std::uint64_t;
 using Length = std::uint64_t;
+using OrderIndex = std::uint32_t;
+using Symbol = std::uint16_t;
 
-enum OrderType { BUY, SELL };
+constexpr OrderIndex NO_ORDER = 0; /**< Null order index: slot 0 of an order pool is never handed out */
 
-enum OrderStatus { ACTIVE, FULFILLED, DELETED };
+enum OrderType : std::uint8_t { BUY, SELL };
+
+/**
+ * Time in force of an order: LIMIT rests what it cannot match, IOC (immediate or cancel) drops it,
+ * FOK (fill or kill) only trades if it can be filled entirely, MARKET is an IOC without price limit
+ */
+enum OrderKind : std::uint8_t { LIMIT, MARKET, IOC, FOK };
+
+enum OrderStatus : std::uint8_t { ACTIVE, FULFILLED, DELETED };
 
 #endif //ORDERBOOK_TYPES_H
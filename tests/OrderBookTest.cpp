@@ -1,288 +1,1618 @@
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
 #include "../src/Book.h"
+#include "../src/Journal.h"
+#include "../src/MatchingEngine.h"
+#include "../src/ReplicaBook.h"
+#include "../src/Sequencer.h"
+#include "../demo/Latency.h"
+#include "../demo/Lobbin.h"
+#include "../demo/OperationReader.h"
+
+namespace {
+
+/** Seeded flow of PLACE, CANCEL and AMEND commands on ids 1..max_id: buys at 70..105, sells at 95..130, some crossing */
+Commands random_commands(std::uint64_t seed, std::size_t count, ID max_id) {
+	std::mt19937_64 rng(seed);
+	Commands commands(count);
+	for (Command& command : commands) {
+		command.id = 1 + rng() % max_id;
+		command.agent_id = rng() % 4;
+		command.type = CommandType(rng() % 3);
+		command.side = OrderType(rng() % 2);
+		command.price = command.side == BUY ? 70 + rng() % 36 : 95 + rng() % 36;
+		command.volume = 1 + rng() % 20;
+	}
+	return commands;
+}
+
+} // namespace
 
 // Order Tests
 TEST(order_test, fill_order_beyond_volume) {
-	Order order(1, 1, BUY, 100, 50);
+	Order order(1, BUY, 100, 50);
 	EXPECT_THROW(order.fill(60), std::logic_error);
 }
 
 TEST(order_test, order_status_after_partial_fill) {
-	Order order(1, 1, BUY, 100, 50);
+	Order order(1, BUY, 100, 50);
 	order.fill(20);
 	EXPECT_EQ(order.get_status(), ACTIVE);
-	EXPECT_EQ(order.get_volume(), 30);
+	EXPECT_EQ(order.get_volume(), 30u);
 }
 
 TEST(order_test, order_status_after_full_fill) {
-	Order order(1, 1, BUY, 100, 50);
+	Order order(1, BUY, 100, 50);
 	order.fill(50);
 	EXPECT_EQ(order.get_status(), FULFILLED);
-	EXPECT_EQ(order.get_volume(), 0);
+	EXPECT_EQ(order.get_volume(), 0u);
 }
 
 TEST(order_test, set_order_status) {
-	Order order(1, 1, BUY, 100, 50);
+	Order order(1, BUY, 100, 50);
 	order.set_status(DELETED);
 	EXPECT_EQ(order.get_status(), DELETED);
 }
 
 TEST(order_test, order_initial_state) {
-	Order order(1, 1, BUY, 100, 50);
-	EXPECT_EQ(order.get_id(), 1);
-	EXPECT_EQ(order.get_agent_id(), 1);
+	Order order(1, BUY, 100, 50);
+	EXPECT_EQ(order.get_id(), 1u);
 	EXPECT_EQ(order.get_type(), BUY);
-	EXPECT_EQ(order.get_price(), 100);
-	EXPECT_EQ(order.get_volume(), 50);
+	EXPECT_EQ(order.get_price(), 100u);
+	EXPECT_EQ(order.get_volume(), 50u);
 	EXPECT_EQ(order.get_status(), ACTIVE);
 }
 
 // Limit Tests
 TEST(limit_test, insert_multiple_orders) {
-	OrderPointer order1 = std::make_shared<Order>(1, 1, BUY, 100, 50);
-	OrderPointer order2 = std::make_shared<Order>(2, 1, BUY, 100, 30);
-	OrderPointer order3 = std::make_shared<Order>(3, 1, BUY, 100, 20);
+	OrderPool pool;
+	Limit limit(100, pool);
+	limit.insert_order(pool.construct(1, BUY, 100, 50));
+	limit.insert_order(pool.construct(2, BUY, 100, 30));
+	limit.insert_order(pool.construct(3, BUY, 100, 20));
 
-	Limit limit(100);
-	limit.insert_order(order1);
-	limit.insert_order(order2);
-	limit.insert_order(order3);
-
-	EXPECT_EQ(limit.get_length(), 3);
-	EXPECT_EQ(limit.get_total_volume(), 100);
+	EXPECT_EQ(limit.get_length(), 3u);
+	EXPECT_EQ(limit.get_total_volume(), 100u);
 }
 
 TEST(limit_test, delete_order_from_limit) {
-	OrderPointer order1 = std::make_shared<Order>(1, 1, BUY, 100, 50);
-	OrderPointer order2 = std::make_shared<Order>(2, 1, BUY, 100, 30);
-	OrderPointer order3 = std::make_shared<Order>(3, 1, BUY, 100, 20);
-
-	Limit limit(100);
-	limit.insert_order(order1);
+	OrderPool pool;
+	OrderIndex order2 = pool.construct(2, BUY, 100, 30);
+	Limit limit(100, pool);
+	limit.insert_order(pool.construct(1, BUY, 100, 50));
 	limit.insert_order(order2);
-	limit.insert_order(order3);
+	limit.insert_order(pool.construct(3, BUY, 100, 20));
 
 	limit.delete_order(order2);
 
-	EXPECT_EQ(limit.get_length(), 2);
-	EXPECT_EQ(limit.get_total_volume(), 70);
+	EXPECT_EQ(limit.get_length(), 2u);
+	EXPECT_EQ(limit.get_total_volume(), 70u);
 }
 
 TEST(limit_test, match_order_partial_fill) {
-	OrderPointer buy_order = std::make_shared<Order>(1, 1, BUY, 100, 50);
-	OrderPointer sell_order = std::make_shared<Order>(2, 2, SELL, 100, 30);
+	OrderPool pool;
+	Order buy_order(1, BUY, 100, 50);
+	OrderIndex sell_order = pool.construct(2, SELL, 100, 30);
 
-	Limit limit(100);
+	Limit limit(100, pool);
 	limit.insert_order(sell_order);
 
-	Trades trades = limit.match_order(buy_order);
+	Trades trades = limit.match_order(&buy_order);
 
-	EXPECT_EQ(trades.size(), 1);
-	EXPECT_EQ(trades[0].get_volume(), 30);
-	EXPECT_EQ(buy_order->get_volume(), 20);
-	EXPECT_EQ(sell_order->get_volume(), 0);
+	EXPECT_EQ(trades.size(), 1u);
+	EXPECT_EQ(trades[0].get_volume(), 30u);
+	EXPECT_EQ(buy_order.get_volume(), 20u);
+	EXPECT_EQ(pool.at(sell_order)->get_volume(), 0u);
 }
 
 TEST(limit_test, match_order_full_fill) {
-	OrderPointer buy_order = std::make_shared<Order>(1, 1, BUY, 100, 50);
-	OrderPointer sell_order1 = std::make_shared<Order>(2, 2, SELL, 100, 30);
-	OrderPointer sell_order2 = std::make_shared<Order>(3, 3, SELL, 100, 20);
+	OrderPool pool;
+	Order buy_order(1, BUY, 100, 50);
+	OrderIndex sell_order1 = pool.construct(2, SELL, 100, 30);
+	OrderIndex sell_order2 = pool.construct(3, SELL, 100, 20);
 
-	Limit limit(100);
+	Limit limit(100, pool);
 	limit.insert_order(sell_order1);
 	limit.insert_order(sell_order2);
 
-	Trades trades = limit.match_order(buy_order);
+	Trades trades = limit.match_order(&buy_order);
 
-	EXPECT_EQ(trades.size(), 2);
-	EXPECT_EQ(trades[0].get_volume(), 30);
-	EXPECT_EQ(trades[1].get_volume(), 20);
-	EXPECT_EQ(buy_order->get_volume(), 0);
-	EXPECT_EQ(sell_order1->get_volume(), 0);
-	EXPECT_EQ(sell_order2->get_volume(), 0);
-	EXPECT_EQ(limit.get_length(), 0);
-	EXPECT_EQ(limit.get_total_volume(), 0);
+	EXPECT_EQ(trades.size(), 2u);
+	EXPECT_EQ(trades[0].get_volume(), 30u);
+	EXPECT_EQ(trades[1].get_volume(), 20u);
+	EXPECT_EQ(buy_order.get_volume(), 0u);
+	EXPECT_EQ(pool.at(sell_order1)->get_volume(), 0u);
+	EXPECT_EQ(pool.at(sell_order2)->get_volume(), 0u);
+	EXPECT_EQ(limit.get_length(), 0u);
+	EXPECT_EQ(limit.get_total_volume(), 0u);
 }
 
 TEST(limit_test, match_order_with_remaining_volume) {
-	OrderPointer buy_order = std::make_shared<Order>(1, 1, BUY, 100, 50);
-	OrderPointer sell_order1 = std::make_shared<Order>(2, 2, SELL, 100, 30);
-	OrderPointer sell_order2 = std::make_shared<Order>(3, 3, SELL, 100, 10);
+	OrderPool pool;
+	Order buy_order(1, BUY, 100, 50);
+	OrderIndex sell_order1 = pool.construct(2, SELL, 100, 30);
+	OrderIndex sell_order2 = pool.construct(3, SELL, 100, 10);
 
-	Limit limit(100);
+	Limit limit(100, pool);
 	limit.insert_order(sell_order1);
 	limit.insert_order(sell_order2);
 
-	Trades trades = limit.match_order(buy_order);
+	Trades trades = limit.match_order(&buy_order);
 
-	EXPECT_EQ(trades.size(), 2);
-	EXPECT_EQ(trades[0].get_volume(), 30);
-	EXPECT_EQ(trades[1].get_volume(), 10);
-	EXPECT_EQ(buy_order->get_volume(), 10);
-	EXPECT_EQ(sell_order1->get_volume(), 0);
-	EXPECT_EQ(sell_order2->get_volume(), 0);
+	EXPECT_EQ(trades.size(), 2u);
+	EXPECT_EQ(trades[0].get_volume(), 30u);
+	EXPECT_EQ(trades[1].get_volume(), 10u);
+	EXPECT_EQ(buy_order.get_volume(), 10u);
+	EXPECT_EQ(pool.at(sell_order1)->get_volume(), 0u);
+	EXPECT_EQ(pool.at(sell_order2)->get_volume(), 0u);
 }
 
 // Book Tests
+// Filled orders leave the book: get_order returns nullptr for them
 TEST(book_test, place_buy_order_no_match) {
 	Book book;
-	OrderPointer buy_order = std::make_shared<Order>(1, 1, BUY, 100, 50);
-	Trades trades = book.place_order(buy_order);
+	Trades trades = book.place_order(1, 1, BUY, 100, 50);
 
-	EXPECT_EQ(trades.size(), 0);
-	EXPECT_EQ(book.get_buy_tree().size(), 1);
-	EXPECT_EQ(book.get_buy_limits().size(), 1);
-	EXPECT_EQ(book.get_best_buy(), 100);
+	EXPECT_EQ(trades.size(), 0u);
+	EXPECT_EQ(book.get_buy_tree().size(), 1u);
+	EXPECT_EQ(book.get_buy_limits().size(), 1u);
+	EXPECT_EQ(book.get_best_buy(), 100u);
 }
 
 TEST(book_test, place_sell_order_no_match) {
 	Book book;
-	OrderPointer sell_order = std::make_shared<Order>(1, 1, SELL, 100, 50);
-	Trades trades = book.place_order(sell_order);
+	Trades trades = book.place_order(1, 1, SELL, 100, 50);
 
-	EXPECT_EQ(trades.size(), 0);
-	EXPECT_EQ(book.get_sell_tree().size(), 1);
-	EXPECT_EQ(book.get_sell_limits().size(), 1);
-	EXPECT_EQ(book.get_best_sell(), 100);
+	EXPECT_EQ(trades.size(), 0u);
+	EXPECT_EQ(book.get_sell_tree().size(), 1u);
+	EXPECT_EQ(book.get_sell_limits().size(), 1u);
+	EXPECT_EQ(book.get_best_sell(), 100u);
 }
 
 TEST(book_test, place_buy_order_with_match) {
 	Book book;
-	OrderPointer sell_order = std::make_shared<Order>(1, 1, SELL, 100, 30);
-	book.place_order(sell_order);
+	book.place_order(1, 1, SELL, 100, 30);
+	Trades trades = book.place_order(2, 2, BUY, 100, 50);
 
-	OrderPointer buy_order = std::make_shared<Order>(2, 2, BUY, 100, 50);
-	Trades trades = book.place_order(buy_order);
+	EXPECT_EQ(trades.size(), 1u);
+	EXPECT_EQ(trades[0].get_volume(), 30u);
+	ASSERT_NE(book.get_order(2), nullptr);
+	EXPECT_EQ(book.get_order(2)->get_volume(), 20u);
+	EXPECT_EQ(book.get_order(1), nullptr);
 
-	EXPECT_EQ(trades.size(), 1);
-	EXPECT_EQ(trades[0].get_volume(), 30);
-	EXPECT_EQ(buy_order->get_volume(), 20);
-	EXPECT_EQ(sell_order->get_volume(), 0);
-
-	EXPECT_EQ(book.get_sell_tree().size(), 0);
-	EXPECT_EQ(book.get_sell_limits().size(), 0);
-	EXPECT_EQ(book.get_buy_tree().size(), 1);
-	EXPECT_EQ(book.get_buy_limits().size(), 1);
+	EXPECT_EQ(book.get_sell_tree().size(), 0u);
+	EXPECT_EQ(book.get_sell_limits().size(), 0u);
+	EXPECT_EQ(book.get_buy_tree().size(), 1u);
+	EXPECT_EQ(book.get_buy_limits().size(), 1u);
 }
 
 TEST(book_test, place_sell_order_with_match) {
 	Book book;
-	OrderPointer buy_order = std::make_shared<Order>(1, 1, BUY, 100, 30);
-	book.place_order(buy_order);
-
-	OrderPointer sell_order = std::make_shared<Order>(2, 2, SELL, 100, 50);
-	Trades trades = book.place_order(sell_order);
+	book.place_order(1, 1, BUY, 100, 30);
+	Trades trades = book.place_order(2, 2, SELL, 100, 50);
 
-	EXPECT_EQ(trades.size(), 1);
-	EXPECT_EQ(trades[0].get_volume(), 30);
-	EXPECT_EQ(sell_order->get_volume(), 20);
-	EXPECT_EQ(buy_order->get_volume(), 0);
+	EXPECT_EQ(trades.size(), 1u);
+	EXPECT_EQ(trades[0].get_volume(), 30u);
+	ASSERT_NE(book.get_order(2), nullptr);
+	EXPECT_EQ(book.get_order(2)->get_volume(), 20u);
+	EXPECT_EQ(book.get_order(1), nullptr);
 
-	EXPECT_EQ(book.get_buy_tree().size(), 0);
-	EXPECT_EQ(book.get_buy_limits().size(), 0);
-	EXPECT_EQ(book.get_sell_tree().size(), 1);
-	EXPECT_EQ(book.get_sell_limits().size(), 1);
+	EXPECT_EQ(book.get_buy_tree().size(), 0u);
+	EXPECT_EQ(book.get_buy_limits().size(), 0u);
+	EXPECT_EQ(book.get_sell_tree().size(), 1u);
+	EXPECT_EQ(book.get_sell_limits().size(), 1u);
 }
 
 TEST(book_test, multiple_orders_same_price) {
 	Book book;
-	OrderPointer buy_order1 = std::make_shared<Order>(1, 1, BUY, 100, 30);
-	OrderPointer buy_order2 = std::make_shared<Order>(2, 1, BUY, 100, 20);
-	book.place_order(buy_order1);
-	book.place_order(buy_order2);
-
-	OrderPointer sell_order = std::make_shared<Order>(3, 2, SELL, 100, 40);
-	Trades trades = book.place_order(sell_order);
+	book.place_order(1, 1, BUY, 100, 30);
+	book.place_order(2, 1, BUY, 100, 20);
+	Trades trades = book.place_order(3, 2, SELL, 100, 40);
 
-	EXPECT_EQ(trades.size(), 2);
-	EXPECT_EQ(trades[0].get_volume(), 30);
-	EXPECT_EQ(trades[1].get_volume(), 10);
-	EXPECT_EQ(sell_order->get_volume(), 0);
-	EXPECT_EQ(buy_order1->get_volume(), 0);
-	EXPECT_EQ(buy_order2->get_volume(), 10);
+	EXPECT_EQ(trades.size(), 2u);
+	EXPECT_EQ(trades[0].get_volume(), 30u);
+	EXPECT_EQ(trades[1].get_volume(), 10u);
+	EXPECT_EQ(book.get_order(3), nullptr);
+	EXPECT_EQ(book.get_order(1), nullptr);
+	ASSERT_NE(book.get_order(2), nullptr);
+	EXPECT_EQ(book.get_order(2)->get_volume(), 10u);
 
-	EXPECT_EQ(book.get_buy_tree().size(), 1);
-	EXPECT_EQ(book.get_buy_limits().size(), 1);
-	EXPECT_EQ(book.get_sell_tree().size(), 0);
-	EXPECT_EQ(book.get_sell_limits().size(), 0);
+	EXPECT_EQ(book.get_buy_tree().size(), 1u);
+	EXPECT_EQ(book.get_buy_limits().size(), 1u);
+	EXPECT_EQ(book.get_sell_tree().size(), 0u);
+	EXPECT_EQ(book.get_sell_limits().size(), 0u);
 }
 
 TEST(book_test, place_order_with_different_prices) {
 	Book book;
-	OrderPointer buy_order1 = std::make_shared<Order>(1, 1, BUY, 100, 30);
-	OrderPointer buy_order2 = std::make_shared<Order>(2, 1, BUY, 110, 20);
-	book.place_order(buy_order1);
-	book.place_order(buy_order2);
+	book.place_order(1, 1, BUY, 100, 30);
+	book.place_order(2, 1, BUY, 110, 20);
+	Trades trades = book.place_order(3, 2, SELL, 105, 40);
 
-	OrderPointer sell_order = std::make_shared<Order>(3, 2, SELL, 105, 40);
-	Trades trades = book.place_order(sell_order);
+	EXPECT_EQ(trades.size(), 1u);
+	EXPECT_EQ(trades[0].get_volume(), 20u);
+	ASSERT_NE(book.get_order(3), nullptr);
+	EXPECT_EQ(book.get_order(3)->get_volume(), 20u);
+	EXPECT_EQ(book.get_order_status(3), ACTIVE);
+	ASSERT_NE(book.get_order(1), nullptr);
+	EXPECT_EQ(book.get_order(1)->get_volume(), 30u);
+	EXPECT_EQ(book.get_order_status(1), ACTIVE);
+	EXPECT_EQ(book.get_order(2), nullptr);
 
-	EXPECT_EQ(trades.size(), 1);
-	EXPECT_EQ(trades[0].get_volume(), 20);
-	EXPECT_EQ(sell_order->get_volume(), 20);
-	EXPECT_EQ(sell_order->get_status(), ACTIVE);
-	EXPECT_EQ(buy_order1->get_volume(), 30);
-	EXPECT_EQ(buy_order1->get_status(), ACTIVE);
-	EXPECT_EQ(buy_order2->get_volume(), 0);
-	EXPECT_EQ(buy_order2->get_status(), FULFILLED);
-
-	EXPECT_EQ(book.get_buy_tree().size(), 1);
-	EXPECT_EQ(book.get_buy_limits().size(), 1);
-	EXPECT_EQ(book.get_sell_tree().size(), 1);
-	EXPECT_EQ(book.get_sell_limits().size(), 1);
+	EXPECT_EQ(book.get_buy_tree().size(), 1u);
+	EXPECT_EQ(book.get_buy_limits().size(), 1u);
+	EXPECT_EQ(book.get_sell_tree().size(), 1u);
+	EXPECT_EQ(book.get_sell_limits().size(), 1u);
 }
 
 TEST(book_test, delete_order) {
 	Book book;
-	OrderPointer buy_order = std::make_shared<Order>(1, 1, BUY, 100, 30);
-	book.place_order(buy_order);
+	book.place_order(1, 1, BUY, 100, 30);
 
 	book.delete_order(1);
 
-	EXPECT_EQ(book.get_buy_tree().size(), 0);
-	EXPECT_EQ(book.get_buy_limits().size(), 0);
+	EXPECT_EQ(book.get_buy_tree().size(), 0u);
+	EXPECT_EQ(book.get_buy_limits().size(), 0u);
 }
 
 TEST(book_test, delete_order_not_in_book) {
 	Book book;
-	OrderPointer buy_order = std::make_shared<Order>(1, 1, BUY, 100, 30);
-	book.place_order(buy_order);
+	book.place_order(1, 1, BUY, 100, 30);
 
 	book.delete_order(2);
 
-	EXPECT_EQ(book.get_buy_tree().size(), 1);
-	EXPECT_EQ(book.get_buy_limits().size(), 1);
+	EXPECT_EQ(book.get_buy_tree().size(), 1u);
+	EXPECT_EQ(book.get_buy_limits().size(), 1u);
 }
 
 TEST(book_test, place_order_with_invalid_price) {
 	Book book;
-	OrderPointer buy_order = std::make_shared<Order>(1, 1, BUY, 0, 30);
-	Trades trades = book.place_order(buy_order);
+	Trades trades = book.place_order(1, 1, BUY, 0, 30);
 
-	EXPECT_EQ(trades.size(), 0);
-	EXPECT_EQ(book.get_buy_tree().size(), 0);
-	EXPECT_EQ(book.get_buy_limits().size(), 0);
+	EXPECT_EQ(trades.size(), 0u);
+	EXPECT_EQ(book.get_buy_tree().size(), 0u);
+	EXPECT_EQ(book.get_buy_limits().size(), 0u);
 }
 
 TEST(book_test, match_orders_with_multiple_limits) {
 	Book book;
-	OrderPointer buy_order1 = std::make_shared<Order>(1, 1, BUY, 100, 30);
-	OrderPointer buy_order2 = std::make_shared<Order>(2, 1, BUY, 110, 20);
-	OrderPointer sell_order1 = std::make_shared<Order>(3, 2, SELL, 105, 15);
-	OrderPointer sell_order2 = std::make_shared<Order>(4, 2, SELL, 95, 30);
-	book.place_order(buy_order1);
-	book.place_order(buy_order2);
-	book.place_order(sell_order1);
-	Trades trades = book.place_order(sell_order2);
-
-	EXPECT_EQ(trades.size(), 2);
-	EXPECT_EQ(trades[0].get_volume(), 5);
-	EXPECT_EQ(trades[1].get_volume(), 25);
-
-	EXPECT_EQ(book.get_buy_tree().size(), 1);
-	EXPECT_EQ(book.get_buy_limits().size(), 1);
-	EXPECT_EQ(book.get_sell_tree().size(), 0);
-	EXPECT_EQ(book.get_sell_limits().size(), 0);
+	book.place_order(1, 1, BUY, 100, 30);
+	book.place_order(2, 1, BUY, 110, 20);
+	book.place_order(3, 2, SELL, 105, 15);
+	Trades trades = book.place_order(4, 2, SELL, 95, 30);
+
+	EXPECT_EQ(trades.size(), 2u);
+	EXPECT_EQ(trades[0].get_volume(), 5u);
+	EXPECT_EQ(trades[1].get_volume(), 25u);
+
+	EXPECT_EQ(book.get_buy_tree().size(), 1u);
+	EXPECT_EQ(book.get_buy_limits().size(), 1u);
+	EXPECT_EQ(book.get_sell_tree().size(), 0u);
+	EXPECT_EQ(book.get_sell_limits().size(), 0u);
+}
+
+// Ladder Tests
+TEST(ladder_test, levels_inside_band_use_ladder) {
+	Book book(BookConfig::ladder_around(100, 0.5));
+	book.place_order(1, 1, BUY, 90, 30);
+	book.place_order(2, 1, SELL, 110, 20);
+
+	EXPECT_EQ(book.get_buy_limits().size(), 0u);
+	EXPECT_EQ(book.get_sell_limits().size(), 0u);
+	EXPECT_EQ(book.get_levels(BUY).size(), 1u);
+	EXPECT_EQ(book.get_levels(SELL).size(), 1u);
+	EXPECT_EQ(book.get_best_buy(), 90u);
+	EXPECT_EQ(book.get_best_sell(), 110u);
+}
+
+TEST(ladder_test, prices_outside_band_fall_back_to_map) {
+	Book book(BookConfig::ladder_around(100, 0.1));
+	book.place_order(1, 1, BUY, 95, 30);
+	book.place_order(2, 1, BUY, 50, 30);
+	book.place_order(3, 1, SELL, 200, 20);
+
+	EXPECT_EQ(book.get_buy_tree().size(), 1u);
+	EXPECT_EQ(book.get_sell_tree().size(), 1u);
+	std::vector<LimitPointer> buys = book.get_levels(BUY);
+	ASSERT_EQ(buys.size(), 2u);
+	EXPECT_EQ(buys[0]->get_price(), 50u);
+	EXPECT_EQ(buys[1]->get_price(), 95u);
+}
+
+TEST(ladder_test, sweep_recovers_best_across_ladder_and_map) {
+	Book book(BookConfig::ladder_around(100, 0.1));
+	book.place_order(1, 1, SELL, 101, 10);
+	book.place_order(2, 1, SELL, 105, 10);
+	book.place_order(3, 1, SELL, 300, 10);
+
+	Trades trades = book.place_order(4, 2, BUY, 105, 20);
+
+	EXPECT_EQ(trades.size(), 2u);
+	EXPECT_EQ(book.get_best_sell(), 300u);
+	book.delete_order(3);
+	EXPECT_EQ(book.get_best_sell(), 0u);
+	EXPECT_EQ(book.get_levels(SELL).size(), 0u);
+}
+
+// Bitmap Tests
+TEST(bitmap_test, finds_neighbours_across_words_and_levels) {
+	PriceBitmap bitmap(1000, 1, 300000);
+	bitmap.set(1003);
+	bitmap.set(1000 + 70000);
+	bitmap.set(1000 + 299999);
+
+	EXPECT_EQ(bitmap.find_highest_at_or_below(1000 + 299998), 1000u + 70000);
+	EXPECT_EQ(bitmap.find_highest_at_or_below(1000 + 69999), 1003u);
+	EXPECT_EQ(bitmap.find_highest_at_or_below(1002), 0u);
+	EXPECT_EQ(bitmap.find_lowest_at_or_above(1004), 1000u + 70000);
+	EXPECT_EQ(bitmap.find_lowest_at_or_above(1000 + 70001), 1000u + 299999);
+
+	bitmap.clear(1000 + 70000);
+	EXPECT_FALSE(bitmap.test(1000 + 70000));
+	EXPECT_EQ(bitmap.find_lowest_at_or_above(1004), 1000u + 299999);
+}
+
+TEST(bitmap_test, covers_only_band_ticks) {
+	PriceBitmap bitmap(100, 5, 10);
+	EXPECT_TRUE(bitmap.covers(100));
+	EXPECT_TRUE(bitmap.covers(145));
+	EXPECT_FALSE(bitmap.covers(150));
+	EXPECT_FALSE(bitmap.covers(102));
+	EXPECT_FALSE(bitmap.covers(95));
+}
+
+TEST(bitmap_test, map_levels_recover_best_with_bitmap) {
+	Book book(BookConfig::bitmap_around(100, 0.1));
+	book.place_order(1, 1, BUY, 99, 10);
+	book.place_order(2, 1, BUY, 92, 10);
+	book.place_order(3, 1, BUY, 50, 10);
+
+	EXPECT_EQ(book.get_buy_limits().size(), 3u);
+	EXPECT_EQ(book.get_buy_tree().size(), 1u);
+
+	book.place_order(4, 2, SELL, 92, 15);
+	EXPECT_EQ(book.get_best_buy(), 92u);
+	book.delete_order(2);
+	EXPECT_EQ(book.get_best_buy(), 50u);
+}
+
+// Slab pool Tests
+TEST(slab_pool_test, released_slot_is_reused_first) {
+	SlabPool<Order> pool(4);
+	Order* first = pool.construct(1, BUY, 100, 10);
+	Order* second = pool.construct(2, BUY, 100, 10);
+	pool.destroy(first);
+
+	Order* third = pool.construct(3, SELL, 101, 5);
+	EXPECT_EQ(third, first);
+	EXPECT_EQ(third->get_id(), 3u);
+	EXPECT_EQ(pool.get_live(), 2u);
+	pool.destroy(second);
+	pool.destroy(third);
+}
+
+TEST(slab_pool_test, grows_by_aligned_slabs) {
+	SlabPool<Order> pool(2, true);
+	pool.reserve(5);
+	EXPECT_EQ(pool.get_slab_count(), 3u);
+
+	std::vector<Order*> orders;
+	for (ID id = 0; id < 7; id++)
+		orders.push_back(pool.construct(id, BUY, 100, 10));
+	EXPECT_EQ(pool.get_slab_count(), 4u);
+	for (Order* order : orders) {
+		EXPECT_EQ(order->get_volume(), 10u);
+		pool.destroy(order);
+	}
+	EXPECT_EQ(pool.get_live(), 0u);
+}
+
+// Queue level Tests
+TEST(queue_level_test, cancels_leave_tombstones_and_keep_priority) {
+	BookConfig config;
+	config.queue_levels = true;
+	Book book(config);
+	for (ID id = 1; id <= 100; id++)
+		book.place_order(id, 1, SELL, 100, 10);
+	for (ID id = 2; id <= 90; id++) // Enough cancels to trigger a compaction
+		if (id % 10 != 0)
+			book.delete_order(id);
+
+	LimitPointer limit = book.get_sell_limits().at(100);
+	EXPECT_TRUE(limit->is_queued());
+	EXPECT_EQ(limit->get_length(), 20u);
+	EXPECT_EQ(limit->get_total_volume(), 200u);
+
+	Trades trades = book.place_order(101, 2, BUY, 100, 35);
+	ASSERT_EQ(trades.size(), 4u);
+	EXPECT_EQ(trades[0].get_matched_order(), 1u);
+	EXPECT_EQ(trades[1].get_matched_order(), 10u);
+	EXPECT_EQ(trades[2].get_matched_order(), 20u);
+	EXPECT_EQ(trades[3].get_matched_order(), 30u);
+	EXPECT_EQ(trades[3].get_volume(), 5u);
+
+	book.delete_order(40);
+	book.delete_order(30);
+	trades = book.place_order(102, 2, BUY, 100, 10);
+	ASSERT_EQ(trades.size(), 1u);
+	EXPECT_EQ(trades[0].get_matched_order(), 50u);
+	EXPECT_EQ(limit->get_length(), 14u);
+}
+
+TEST(queue_level_test, consumed_front_is_dropped) {
+	BookConfig config;
+	config.queue_levels = true;
+	Book book(config);
+	for (ID id = 1; id <= 200; id++)
+		book.place_order(id, 1, BUY, 100, 10);
+	book.place_order(201, 2, SELL, 100, 1500); // Consumes the first 150 orders
+	book.place_order(202, 1, BUY, 100, 10);
+	book.delete_order(199); // Positions survive the dropped prefix
+
+	EXPECT_EQ(book.get_buy_limits().at(100)->get_length(), 50u);
+	Trades trades = book.place_order(203, 2, SELL, 100, 500);
+	ASSERT_EQ(trades.size(), 50u);
+	EXPECT_EQ(trades[0].get_matched_order(), 151u);
+	EXPECT_EQ(trades[48].get_matched_order(), 200u);
+	EXPECT_EQ(trades[49].get_matched_order(), 202u);
+	EXPECT_EQ(book.get_best_buy(), 0u);
+}
+
+// Indexed pool Tests
+TEST(indexed_pool_test, indices_and_generations) {
+	OrderPool pool(3); // Rounded up to 4 slots per slab
+	OrderIndex first = pool.construct(1, BUY, 100, 10);
+	pool.cold(first) = {7, 10};
+	OrderIndex second = pool.construct(2, SELL, 101, 20);
+
+	EXPECT_EQ(pool.get_slab_size(), 4u);
+	EXPECT_NE(first, NO_ORDER);
+	EXPECT_EQ(pool.at(first)->get_id(), 1u);
+	EXPECT_EQ(pool.at(second)->get_price(), 101u);
+	EXPECT_EQ(pool.cold(first).agent_id, 7u);
+
+	IndexedPool<Order, OrderInfo>::Generation generation = pool.get_generation(first);
+	EXPECT_TRUE(pool.is_current(first, generation));
+	pool.destroy(first);
+	EXPECT_FALSE(pool.is_current(first, generation));
+	EXPECT_EQ(pool.construct(3, BUY, 99, 5), first);
+	EXPECT_EQ(pool.get_live(), 2u);
+}
+
+TEST(indexed_pool_test, grows_by_power_of_two_slabs) {
+	OrderPool pool(4);
+	for (ID id = 1; id <= 8; id++)
+		EXPECT_EQ(pool.at(pool.construct(id, BUY, 100, 10))->get_id(), id);
+	EXPECT_EQ(pool.get_slab_count(), 3u); // Slot 0 is never handed out
+	pool.reserve(20);
+	EXPECT_GE(pool.get_capacity(), 21u);
+}
+
+TEST(book_test, cold_order_data) {
+	Book book;
+	book.place_order(1, 42, BUY, 100, 30);
+	book.place_order(2, 43, SELL, 100, 10);
+
+	ASSERT_NE(book.get_order_info(1), nullptr);
+	EXPECT_EQ(book.get_order_info(1)->agent_id, 42u);
+	EXPECT_EQ(book.get_order_info(1)->initial_volume, 30u);
+	EXPECT_EQ(book.get_order(1)->get_volume(), 20u);
+	EXPECT_EQ(book.get_order_info(2), nullptr);
+}
+
+// Trade sink Tests
+TEST(trade_sink_test, sink_receives_trades_in_order) {
+	Book book;
+	book.place_order(1, 1, SELL, 100, 10);
+	book.place_order(2, 1, SELL, 101, 10);
+
+	std::vector<ID> matched;
+	Volume volume = 0;
+	book.place_order(3, 2, BUY, 101, 15, [&](const Trade& trade) {
+		matched.push_back(trade.get_matched_order());
+		volume += trade.get_volume();
+	});
+
+	EXPECT_EQ(matched, std::vector<ID>({1, 2}));
+	EXPECT_EQ(volume, 15u);
+	EXPECT_EQ(book.get_best_sell(), 101u);
+}
+
+TEST(trade_sink_test, buffer_is_appended_to) {
+	Book book;
+	book.place_order(1, 1, BUY, 100, 10);
+	book.place_order(2, 1, BUY, 100, 10);
+
+	Trades trades;
+	book.place_order(3, 2, SELL, 100, 5, trades);
+	book.place_order(4, 2, SELL, 100, 10, trades);
+
+	ASSERT_EQ(trades.size(), 3u);
+	EXPECT_EQ(trades[0].get_matched_order(), 1u);
+	EXPECT_EQ(trades[1].get_matched_order(), 1u);
+	EXPECT_EQ(trades[2].get_matched_order(), 2u);
+	EXPECT_EQ(book.get_buy_limits().size(), 1u);
+}
+
+TEST(trade_sink_test, filled_orders_leave_the_book) {
+	Book book;
+	book.place_order(1, 1, SELL, 100, 10);
+	book.place_order(2, 1, SELL, 100, 10);
+	book.place_order(3, 1, SELL, 101, 10);
+
+	book.place_order(4, 2, BUY, 101, 25, [](const Trade&) {});
+
+	EXPECT_EQ(book.get_id_to_order().size(), 1u);
+	EXPECT_EQ(book.get_id_to_order().count(3), 1u);
+	EXPECT_EQ(book.get_order(3)->get_volume(), 5u);
+	EXPECT_EQ(book.get_best_sell(), 101u);
+}
+
+// Handle Tests
+TEST(handle_test, cancel_by_handle) {
+	Book book;
+	OrderHandle handle = book.place_order(1, 1, BUY, 100, 10, [](const Trade&) {}).handle;
+	book.place_order(2, 1, BUY, 100, 10, [](const Trade&) {});
+
+	ASSERT_TRUE(handle.is_valid());
+	EXPECT_EQ(book.get_order_status(handle), ACTIVE);
+	EXPECT_TRUE(book.cancel(handle));
+	EXPECT_FALSE(book.cancel(handle));
+	EXPECT_EQ(book.get_order_status(handle), DELETED);
+	EXPECT_EQ(book.get_id_to_order().count(1), 0u);
+	EXPECT_EQ(book.get_buy_limits().at(100)->get_total_volume(), 10u);
+}
+
+TEST(handle_test, stale_handle_does_not_reach_reused_slot) {
+	Book book;
+	Trades trades;
+	OrderHandle filled = book.place_order(1, 1, SELL, 100, 10, trades).handle;
+	EXPECT_FALSE(book.place_order(2, 2, BUY, 100, 10, trades).handle.is_valid()); // Fully matched: never rests
+	// Slots are reused last released first: order 2's slot, then order 1's
+	OrderHandle other = book.place_order(3, 1, SELL, 101, 10, trades).handle;
+	OrderHandle reused = book.place_order(4, 1, SELL, 102, 10, trades).handle;
+
+	EXPECT_NE(other.index, filled.index);
+	EXPECT_EQ(reused.index, filled.index);
+	EXPECT_NE(reused.generation, filled.generation);
+	EXPECT_FALSE(book.cancel(filled));
+	EXPECT_EQ(book.get_best_sell(), 101u);
+	EXPECT_TRUE(book.cancel(reused));
+	EXPECT_TRUE(book.cancel(other));
+	EXPECT_EQ(book.get_best_sell(), 0u);
+}
+
+// Place Result Tests
+TEST(place_result_test, outcome_without_lookup) {
+	Book book;
+	Trades trades;
+	book.place_order(1, 1, SELL, 100, 5, trades);
+	book.place_order(2, 1, SELL, 101, 5, trades);
+
+	PlaceResult partial = book.place_order(3, 2, BUY, 101, 12, trades);
+	EXPECT_EQ(partial.status, ACTIVE);
+	EXPECT_EQ(partial.filled, 10u);
+	EXPECT_EQ(partial.remaining, 2u);
+	EXPECT_EQ(partial.fills, 2u);
+	EXPECT_FALSE(partial.is_rejected());
+	EXPECT_TRUE(partial.handle.is_valid());
+	EXPECT_EQ(book.get_order_status(partial.handle), ACTIVE);
+
+	PlaceResult full = book.place_order(4, 1, SELL, 100, 2, trades);
+	EXPECT_EQ(full.status, FULFILLED);
+	EXPECT_EQ(full.filled, 2u);
+	EXPECT_EQ(full.remaining, 0u);
+	EXPECT_EQ(full.fills, 1u);
+	EXPECT_FALSE(full.handle.is_valid());
+	EXPECT_EQ(trades.size(), 3u);
+
+	PlaceResult resting = book.place_order(5, 1, SELL, 110, 7, trades);
+	EXPECT_TRUE(resting.is_resting());
+	EXPECT_EQ(resting.filled, 0u);
+	EXPECT_EQ(resting.remaining, 7u);
+	EXPECT_EQ(resting.fills, 0u);
+}
+
+TEST(place_result_test, rejections) {
+	Book book;
+	Trades trades;
+	book.place_order(1, 1, BUY, 100, 10, trades);
+
+	PlaceResult duplicate = book.place_order(1, 1, BUY, 99, 10, trades);
+	EXPECT_EQ(duplicate.status, DELETED);
+	EXPECT_EQ(duplicate.reject_reason, DUPLICATE_ID);
+	EXPECT_FALSE(duplicate.handle.is_valid());
+
+	PlaceResult no_price = book.place_order(2, 1, SELL, 0, 10, trades);
+	EXPECT_TRUE(no_price.is_rejected());
+	EXPECT_EQ(no_price.reject_reason, INVALID_PRICE);
+	EXPECT_EQ(no_price.filled, 0u);
+	EXPECT_EQ(book.get_buy_limits().at(100)->get_total_volume(), 10u);
+	EXPECT_TRUE(trades.empty());
+}
+
+// Stats Tests
+TEST(stats_test, snapshot) {
+	BookConfig config;
+	config.queue_levels = true;
+	Book book(config);
+	Trades trades;
+	for (ID id = 1; id <= 40; id++)
+		book.place_order(id, 1, SELL, 100, 10, trades);
+	book.place_order(41, 1, SELL, 101, 10, trades);
+	for (ID id = 1; id <= 39; id++)
+		book.delete_order(id); // Tombstones until the limit is compacted
+	book.place_order(42, 1, SELL, 0, 10, trades);
+	book.place_order(41, 1, SELL, 102, 10, trades);
+	book.place_order(43, 2, BUY, 101, 15, trades); // Empties level 100, then trades at 101
+
+	BookStats stats = book.get_stats();
+	EXPECT_EQ(stats.live_orders, 1u);
+	EXPECT_EQ(stats.buy_levels, 0u);
+	EXPECT_EQ(stats.sell_levels, 1u);
+	EXPECT_EQ(stats.order_slabs, 1u);
+	EXPECT_EQ(stats.limit_slabs, 1u);
+	EXPECT_GT(stats.id_buckets, 0u);
+	if (STATS_ENABLED) {
+		EXPECT_EQ(stats.levels_created, 2u);
+		EXPECT_EQ(stats.levels_destroyed, 1u);
+		EXPECT_EQ(stats.match_calls, 2u);
+		EXPECT_EQ(stats.orders_walked, 9u); // Orders 40 and 41, and the 7 tombstones left after the compaction
+		EXPECT_EQ(stats.tombstones_skipped, 7u);
+		EXPECT_EQ(stats.queue_compactions, 1u);
+		EXPECT_EQ(stats.best_recomputations, 1u);
+		EXPECT_EQ(stats.duplicate_rejects, 1u);
+		EXPECT_EQ(stats.invalid_price_rejects, 1u);
+		EXPECT_GT(stats.id_lookups, 80u);
+		book.reset_stats();
+		EXPECT_EQ(book.get_stats().levels_created, 0u);
+	} else {
+		EXPECT_EQ(stats.levels_created, 0u);
+		EXPECT_EQ(stats.id_lookups, 0u);
+	}
+}
+
+// Order Kind Tests
+TEST(order_kind_test, market_and_ioc_never_rest) {
+	Book book;
+	Trades trades;
+	book.place_order(1, 1, SELL, 100, 5, trades);
+	book.place_order(2, 1, SELL, 120, 5, trades);
+
+	PlaceResult ioc = book.place_order(3, 2, BUY, IOC, 110, 8, trades);
+	EXPECT_EQ(ioc.status, DELETED);
+	EXPECT_FALSE(ioc.is_rejected());
+	EXPECT_EQ(ioc.filled, 5u);
+	EXPECT_EQ(ioc.remaining, 0u);
+	EXPECT_FALSE(ioc.handle.is_valid());
+	EXPECT_EQ(book.get_order(3), nullptr);
+	EXPECT_EQ(book.get_best_buy(), 0u);
+
+	PlaceResult market = book.place_order(4, 2, BUY, MARKET, 0, 3, trades);
+	EXPECT_EQ(market.status, FULFILLED);
+	EXPECT_EQ(market.filled, 3u);
+	EXPECT_EQ(book.get_sell_limits().at(120)->get_total_volume(), 2u);
+
+	book.place_order(5, 1, BUY, 90, 4, trades);
+	PlaceResult sell_market = book.place_order(6, 2, SELL, MARKET, 0, 10, trades);
+	EXPECT_EQ(sell_market.status, DELETED);
+	EXPECT_EQ(sell_market.filled, 4u);
+	EXPECT_EQ(book.get_best_buy(), 0u);
+	EXPECT_EQ(trades.size(), 3u);
+	EXPECT_EQ(book.get_id_to_order().size(), 1u);
+}
+
+TEST(order_kind_test, fok_rejected_without_touching_the_book) {
+	Book book;
+	Trades trades;
+	book.place_order(1, 1, SELL, 100, 5, trades);
+	book.place_order(2, 1, SELL, 101, 5, trades);
+	book.place_order(3, 1, SELL, 105, 5, trades);
+
+	PlaceResult rejected = book.place_order(4, 2, BUY, FOK, 101, 11, trades);
+	EXPECT_EQ(rejected.status, DELETED);
+	EXPECT_EQ(rejected.reject_reason, NOT_FILLABLE);
+	EXPECT_EQ(rejected.fills, 0u);
+	EXPECT_TRUE(trades.empty());
+	EXPECT_EQ(book.get_sell_limits().at(100)->get_total_volume(), 5u);
+	EXPECT_EQ(book.get_best_sell(), 100u);
+
+	PlaceResult filled = book.place_order(5, 2, BUY, FOK, 101, 10, trades);
+	EXPECT_EQ(filled.status, FULFILLED);
+	EXPECT_EQ(filled.filled, 10u);
+	EXPECT_EQ(filled.fills, 2u);
+	EXPECT_EQ(book.get_best_sell(), 105u);
+	EXPECT_EQ(book.get_order(5), nullptr);
+}
+
+TEST(order_kind_test, duplicate_id_rejected_for_every_kind) {
+	Book book;
+	Trades trades;
+	book.place_order(1, 1, SELL, 100, 10, trades);
+	for (OrderKind kind : {MARKET, IOC, FOK}) {
+		PlaceResult result = book.place_order(1, 2, BUY, kind, 100, 5, trades);
+		EXPECT_EQ(result.reject_reason, DUPLICATE_ID);
+		EXPECT_EQ(result.filled, 0u);
+	}
+	EXPECT_TRUE(trades.empty()); // The order never trades with itself
+	EXPECT_EQ(book.get_sell_limits().at(100)->get_total_volume(), 10u);
+	if (STATS_ENABLED) {
+		EXPECT_EQ(book.get_stats().duplicate_rejects, 3u);
+	}
+}
+
+TEST(order_kind_test, fok_depth_walks_band_and_tree) {
+	Book book(BookConfig::bitmap_around(100, 0.1));
+	Trades trades;
+	book.place_order(1, 1, BUY, 99, 10, trades);
+	book.place_order(2, 1, BUY, 92, 10, trades);
+	book.place_order(3, 1, BUY, 50, 10, trades); // Outside of the band, in the tree
+
+	EXPECT_EQ(book.place_order(4, 2, SELL, FOK, 50, 31, trades).reject_reason, NOT_FILLABLE);
+	EXPECT_EQ(book.place_order(5, 2, SELL, FOK, 92, 25, trades).reject_reason, NOT_FILLABLE);
+	EXPECT_TRUE(trades.empty());
+
+	PlaceResult sweep = book.place_order(6, 2, SELL, FOK, 50, 30, trades);
+	EXPECT_EQ(sweep.status, FULFILLED);
+	EXPECT_EQ(sweep.fills, 3u);
+	EXPECT_EQ(book.get_best_buy(), 0u);
+	EXPECT_EQ(book.place_order(7, 2, SELL, IOC, 0, 1, trades).reject_reason, INVALID_PRICE);
+}
+
+// Amend Tests
+TEST(amend_test, volume_decrease_keeps_priority) {
+	Book book;
+	Trades trades;
+	PlaceResult first = book.place_order(1, 1, SELL, 100, 10, trades);
+	book.place_order(2, 1, SELL, 100, 10, trades);
+
+	PlaceResult amended = book.amend_order(1, 100, 4, trades);
+	EXPECT_EQ(amended.status, ACTIVE);
+	EXPECT_EQ(amended.remaining, 4u);
+	EXPECT_EQ(amended.handle, first.handle);
+	EXPECT_EQ(book.get_sell_limits().at(100)->get_total_volume(), 14u);
+
+	book.place_order(3, 2, BUY, 100, 5, trades);
+	ASSERT_EQ(trades.size(), 2u);
+	EXPECT_EQ(trades[0].get_matched_order(), 1u);
+	EXPECT_EQ(trades[0].get_volume(), 4u);
+	EXPECT_EQ(trades[1].get_matched_order(), 2u);
+}
+
+TEST(amend_test, volume_increase_loses_priority) {
+	BookConfig config;
+	config.queue_levels = true;
+	Book book(config);
+	Trades trades;
+	book.place_order(1, 1, BUY, 100, 10, trades);
+	book.place_order(2, 1, BUY, 100, 10, trades);
+
+	EXPECT_EQ(book.amend_order(1, 100, 15, trades).remaining, 15u);
+	EXPECT_EQ(book.get_buy_limits().at(100)->get_total_volume(), 25u);
+	book.place_order(3, 2, SELL, 100, 12, trades);
+	ASSERT_EQ(trades.size(), 2u);
+	EXPECT_EQ(trades[0].get_matched_order(), 2u);
+	EXPECT_EQ(trades[1].get_matched_order(), 1u);
+	EXPECT_EQ(book.get_order(1)->get_volume(), 13u);
+}
+
+TEST(amend_test, price_change_moves_and_matches) {
+	Book book;
+	Trades trades;
+	book.place_order(1, 1, SELL, 105, 5, trades);
+	PlaceResult placed = book.place_order(2, 2, BUY, 100, 10, trades);
+
+	PlaceResult moved = book.amend_order(placed.handle, 101, 10, [](const Trade&) {});
+	EXPECT_EQ(moved.status, ACTIVE);
+	EXPECT_EQ(moved.handle, placed.handle);
+	EXPECT_FALSE(book.get_buy_limits().contains(100));
+	EXPECT_EQ(book.get_best_buy(), 101u);
+
+	PlaceResult crossed = book.amend_order(2, 105, 8, trades);
+	EXPECT_EQ(crossed.status, ACTIVE);
+	EXPECT_EQ(crossed.filled, 5u);
+	EXPECT_EQ(crossed.remaining, 3u);
+	EXPECT_EQ(crossed.fills, 1u);
+	EXPECT_EQ(book.get_best_sell(), 0u);
+	EXPECT_EQ(book.get_best_buy(), 105u);
+	EXPECT_EQ(book.get_order_info(2)->agent_id, 2u);
+}
+
+TEST(amend_test, refused_and_cancelling_amends) {
+	Book book;
+	Trades trades;
+	PlaceResult placed = book.place_order(1, 1, BUY, 100, 10, trades);
+
+	PlaceResult no_price = book.amend_order(1, 0, 5, trades);
+	EXPECT_EQ(no_price.reject_reason, INVALID_PRICE);
+	EXPECT_EQ(no_price.status, ACTIVE);
+	EXPECT_EQ(book.get_order(1)->get_volume(), 10u);
+	EXPECT_EQ(book.amend_order(2, 100, 5, trades).reject_reason, UNKNOWN_ORDER);
+
+	EXPECT_EQ(book.amend_order(1, 100, 0, trades).status, DELETED);
+	EXPECT_EQ(book.get_order(1), nullptr);
+	EXPECT_EQ(book.get_best_buy(), 0u);
+	EXPECT_EQ(book.amend_order(placed.handle, 100, 5, [](const Trade&) {}).reject_reason, UNKNOWN_ORDER);
+}
+
+// Batch Tests
+TEST(batch_test, same_outcome_as_sequential_calls) {
+	// Small id and price ranges: cancels and amends often target orders filled or replaced earlier in the window
+	std::mt19937_64 rng(42);
+	Commands commands(2000);
+	for (Command& command : commands) {
+		command.id = 1 + rng() % 64;
+		command.agent_id = 1;
+		command.type = CommandType(rng() % 3);
+		command.side = OrderType(rng() % 2);
+		command.price = 95 + rng() % 10;
+		command.volume = 1 + rng() % 20;
+	}
+	for (bool queue_levels : {false, true}) {
+		BookConfig config = BookConfig::ladder_around(100, 0.1);
+		config.queue_levels = queue_levels;
+		Book sequential(config);
+		Book batched(config);
+		Trades expected;
+		std::vector<PlaceResult> expected_results;
+		for (const Command& command : commands) {
+			if (command.type == PLACE) {
+				expected_results.push_back(sequential.place_order(command.id, command.agent_id, command.side, command.price, command.volume, expected));
+			} else if (command.type == AMEND) {
+				expected_results.push_back(sequential.amend_order(command.id, command.price, command.volume, expected));
+			} else {
+				bool resting = sequential.get_order(command.id) != nullptr;
+				sequential.delete_order(command.id);
+				expected_results.push_back(resting ? PlaceResult() : PlaceResult::rejected(UNKNOWN_ORDER));
+			}
+		}
+
+		Trades trades;
+		std::vector<PlaceResult> results(commands.size());
+		for (std::size_t first = 0; first < commands.size(); first += 100)
+			batched.process_batch(std::span(commands).subspan(first, 100), [&trades](const Trade& trade) { trades.push_back(trade); },
+					std::span(results).subspan(first, 100));
+
+		ASSERT_EQ(trades.size(), expected.size());
+		for (std::size_t i = 0; i < trades.size(); i++) {
+			EXPECT_EQ(trades[i].get_incoming_order(), expected[i].get_incoming_order());
+			EXPECT_EQ(trades[i].get_matched_order(), expected[i].get_matched_order());
+			EXPECT_EQ(trades[i].get_volume(), expected[i].get_volume());
+		}
+		for (std::size_t i = 0; i < results.size(); i++) {
+			EXPECT_EQ(results[i].status, expected_results[i].status);
+			EXPECT_EQ(results[i].reject_reason, expected_results[i].reject_reason);
+			EXPECT_EQ(results[i].remaining, expected_results[i].remaining);
+		}
+		EXPECT_EQ(batched.get_id_to_order().size(), sequential.get_id_to_order().size());
+		EXPECT_EQ(batched.get_best_buy(), sequential.get_best_buy());
+		EXPECT_EQ(batched.get_best_sell(), sequential.get_best_sell());
+	}
+}
+
+// Depth Tests
+TEST(depth_test, best_levels_with_volume_and_count) {
+	BookConfig config;
+	config.depth_levels = 2;
+	Book book(config);
+	book.place_order(1, 1, BUY, 99, 10);
+	book.place_order(2, 1, BUY, 100, 5);
+	book.place_order(3, 1, BUY, 100, 7);
+	book.place_order(4, 1, BUY, 98, 1);
+	book.place_order(5, 1, SELL, 101, 3);
+
+	DepthLevel levels[3];
+	ASSERT_EQ(book.get_depth(BUY, levels), 2u); // Capped by depth_levels
+	EXPECT_EQ(levels[0], (DepthLevel{100, 12, 2}));
+	EXPECT_EQ(levels[1], (DepthLevel{99, 10, 1}));
+	ASSERT_EQ(book.get_depth(SELL, levels), 1u);
+	EXPECT_EQ(levels[0], (DepthLevel{101, 3, 1}));
+
+	// Sweeping 100 brings 98 into the view
+	book.place_order(6, 1, SELL, 100, 12);
+	ASSERT_EQ(book.get_depth(BUY, levels), 2u);
+	EXPECT_EQ(levels[0], (DepthLevel{99, 10, 1}));
+	EXPECT_EQ(levels[1], (DepthLevel{98, 1, 1}));
+	book.delete_order(1);
+	ASSERT_EQ(book.get_depth(BUY, std::span(levels, 1)), 1u);
+	EXPECT_EQ(levels[0], (DepthLevel{98, 1, 1}));
+}
+
+TEST(depth_test, maintained_view_matches_rebuilt_depth) {
+	// Prices on both sides of the band edges, so that levels move between the ladder or bitmap and the tree
+	Commands commands = random_commands(7, 5000, 200);
+	std::vector<BookConfig> configs = {BookConfig(), BookConfig::ladder_around(100, 0.1), BookConfig::bitmap_around(100, 0.1)};
+	configs.push_back(configs[1]);
+	configs.back().queue_levels = true;
+	for (BookConfig config : configs) {
+		Book rebuilt(config);
+		config.depth_levels = 4;
+		Book maintained(config);
+		for (const Command& command : commands) {
+			for (Book* book : {&rebuilt, &maintained}) {
+				if (command.type == PLACE)
+					book->place_order(command.id, 1, command.side, command.price, command.volume, [](const Trade&) {});
+				else if (command.type == AMEND)
+					book->amend_order(command.id, command.price, command.volume, [](const Trade&) {});
+				else
+					book->delete_order(command.id);
+			}
+			for (OrderType side : {BUY, SELL}) {
+				DepthLevel expected[4], levels[4];
+				std::size_t count = rebuilt.get_depth(side, expected);
+				ASSERT_EQ(maintained.get_depth(side, levels), count);
+				for (std::size_t i = 0; i < count; i++)
+					ASSERT_EQ(levels[i], expected[i]);
+			}
+		}
+	}
+}
+
+// L2 Feed Tests
+TEST(level_feed_test, one_update_per_level_and_command) {
+	Book book;
+	LevelRing ring(4);
+	book.set_level_feed(&ring);
+	book.place_order(1, 1, SELL, 101, 5);
+	book.place_order(2, 1, SELL, 101, 5);
+	book.place_order(3, 1, SELL, 102, 5);
+	LevelUpdate update;
+	for (std::uint64_t sequence = 0; sequence < 3; sequence++)
+		ASSERT_TRUE(ring.try_pop(update));
+	EXPECT_EQ(update.sequence, 2u);
+	EXPECT_EQ(update.price, 102u);
+
+	// Two fills at 101 and one at 102, then the rest at 102 on the buy side: one update per level
+	book.place_order(4, 1, BUY, 102, 18);
+	ASSERT_TRUE(ring.try_pop(update));
+	EXPECT_EQ(update.sequence, 3u);
+	EXPECT_EQ(update.side, SELL);
+	EXPECT_EQ(update.price, 101u);
+	EXPECT_EQ(update.count, 0u);
+	EXPECT_EQ(update.volume, 0u);
+	ASSERT_TRUE(ring.try_pop(update));
+	EXPECT_EQ(update.price, 102u);
+	EXPECT_EQ(update.side, SELL);
+	EXPECT_EQ(update.count, 0u);
+	ASSERT_TRUE(ring.try_pop(update));
+	EXPECT_EQ(update.side, BUY);
+	EXPECT_EQ(update.volume, 3u);
+	EXPECT_EQ(update.count, 1u);
+	EXPECT_FALSE(ring.try_pop(update));
+
+	// A full ring drops updates, the consumer sees the gap
+	for (ID id = 10; id < 16; id++)
+		book.place_order(id, 1, BUY, static_cast<Price>(id), 1);
+	LevelBook levels;
+	EXPECT_EQ(levels.drain(ring), 4u);
+	EXPECT_EQ(levels.get_gaps(), 6u); // Sequences 0 to 5 were read above
+	book.place_order(20, 1, BUY, 20, 1);
+	levels.drain(ring);
+	EXPECT_EQ(levels.get_gaps(), 8u);
+	if (STATS_ENABLED) {
+		EXPECT_EQ(book.get_stats().level_updates_dropped, 2u);
+	}
+}
+
+TEST(level_feed_test, consumer_rebuilds_the_levels) {
+	Commands commands = random_commands(11, 5000, 200);
+	BookConfig queued = BookConfig::ladder_around(100, 0.1);
+	queued.queue_levels = true;
+	for (const BookConfig& config : {BookConfig(), BookConfig::bitmap_around(100, 0.1), queued}) {
+		Book book(config);
+		LevelRing ring(1024);
+		LevelBook levels;
+		book.set_level_feed(&ring);
+		for (std::size_t first = 0; first < commands.size(); first += 50) {
+			book.process_batch(std::span(commands).subspan(first, 50), [](const Trade&) {});
+			levels.drain(ring);
+			for (OrderType side : {BUY, SELL}) {
+				std::vector<LimitPointer> expected = book.get_levels(side);
+				std::vector<DepthLevel> rebuilt = levels.get_levels(side);
+				ASSERT_EQ(rebuilt.size(), expected.size());
+				for (std::size_t i = 0; i < rebuilt.size(); i++) {
+					LimitPointer limit = expected[side == BUY ? expected.size() - 1 - i : i];
+					ASSERT_EQ(rebuilt[i], (DepthLevel{limit->get_price(), limit->get_total_volume(), limit->get_length()}));
+				}
+			}
+		}
+		EXPECT_EQ(levels.get_gaps(), 0u);
+	}
+}
+
+// L3 Feed Tests
+TEST(order_feed_test, events_of_an_order_life) {
+	Book book;
+	OrderEventRing ring(64);
+	book.set_order_feed(&ring);
+	book.place_order(1, 1, SELL, 101, 10);
+	book.place_order(2, 1, BUY, 101, 4); // Partial fill of 1
+	book.amend_order(1, 101, 5, [](const Trade&) {}); // In place
+	book.amend_order(1, 101, 8, [](const Trade&) {}); // Back of the queue
+	book.delete_order(1);
+
+	struct Expected { OrderEventType type; ID id; ID incoming_id; Volume volume; };
+	std::vector<Expected> expected = {
+		{ADD_ORDER, 1, 0, 10}, {EXECUTE_ORDER, 1, 2, 4}, {MODIFY_ORDER, 1, 0, 5},
+		{DELETE_ORDER, 1, 0, 5}, {ADD_ORDER, 1, 0, 8}, {DELETE_ORDER, 1, 0, 8}};
+	OrderEvent event;
+	for (std::size_t i = 0; i < expected.size(); i++) {
+		ASSERT_TRUE(ring.try_pop(event));
+		EXPECT_EQ(event.sequence, i);
+		EXPECT_EQ(event.type, expected[i].type);
+		EXPECT_EQ(event.id, expected[i].id);
+		EXPECT_EQ(event.incoming_id, expected[i].incoming_id);
+		EXPECT_EQ(event.volume, expected[i].volume);
+		EXPECT_EQ(event.price, 101u);
+		EXPECT_EQ(event.side, SELL);
+	}
+	EXPECT_FALSE(ring.try_pop(event));
+}
+
+TEST(order_feed_test, replica_follows_the_book) {
+	Commands commands = random_commands(5, 5000, 200);
+	BookConfig queued = BookConfig::ladder_around(100, 0.1);
+	queued.queue_levels = true;
+	for (const BookConfig& config : {BookConfig(), queued}) {
+		Book book(config);
+		OrderEventRing ring(1024);
+		ReplicaBook replica;
+		book.set_order_feed(&ring);
+		for (std::size_t first = 0; first < commands.size(); first += 50) {
+			book.process_batch(std::span(commands).subspan(first, 50), [](const Trade&) {});
+			replica.drain(ring);
+			ASSERT_EQ(replica.get_nb_orders(), book.get_id_to_order().size());
+			for (auto& [id, index] : book.get_id_to_order()) {
+				Order* order = replica.get_order(id);
+				ASSERT_NE(order, nullptr);
+				EXPECT_EQ(order->get_price(), book.get_order(id)->get_price());
+				EXPECT_EQ(order->get_volume(), book.get_order(id)->get_volume());
+			}
+			for (OrderType side : {BUY, SELL}) {
+				DepthLevel expected[64];
+				std::size_t count = book.get_depth(side, expected);
+				std::vector<DepthLevel> levels = replica.get_levels(side);
+				ASSERT_EQ(levels.size(), count);
+				for (std::size_t i = 0; i < count; i++)
+					ASSERT_EQ(levels[i], expected[i]);
+			}
+		}
+		EXPECT_EQ(replica.get_gaps(), 0u);
+	}
+}
+
+// Snapshot Tests
+TEST(snapshot_test, restored_book_trades_like_the_original) {
+	Commands before = random_commands(9, 3000, 500);
+	Commands after = random_commands(10, 3000, 500);
+	std::string path = ::testing::TempDir() + "book.snapshot";
+	BookConfig queued = BookConfig::ladder_around(100, 0.1);
+	queued.queue_levels = true;
+	for (const BookConfig& config : {BookConfig(), queued}) {
+		Book original(config);
+		original.process_batch(before, [](const Trade&) {});
+		ASSERT_TRUE(original.save_snapshot(path));
+		Book restored(config);
+		ASSERT_TRUE(restored.load_snapshot(path));
+		EXPECT_FALSE(restored.load_snapshot(path)); // Not empty any more
+
+		EXPECT_EQ(restored.get_best_buy(), original.get_best_buy());
+		EXPECT_EQ(restored.get_best_sell(), original.get_best_sell());
+		ASSERT_EQ(restored.get_id_to_order().size(), original.get_id_to_order().size());
+		for (auto& [id, index] : original.get_id_to_order()) {
+			ASSERT_NE(restored.get_order(id), nullptr);
+			EXPECT_EQ(restored.get_order(id)->get_volume(), original.get_order(id)->get_volume());
+			EXPECT_EQ(restored.get_order_info(id)->agent_id, original.get_order_info(id)->agent_id);
+			EXPECT_EQ(restored.get_order_info(id)->initial_volume, original.get_order_info(id)->initial_volume);
+		}
+
+		// Same time priority: the same commands give the same trades
+		Trades expected, trades;
+		original.process_batch(after, [&expected](const Trade& trade) { expected.push_back(trade); });
+		restored.process_batch(after, [&trades](const Trade& trade) { trades.push_back(trade); });
+		ASSERT_EQ(trades.size(), expected.size());
+		for (std::size_t i = 0; i < trades.size(); i++) {
+			EXPECT_EQ(trades[i].get_matched_order(), expected[i].get_matched_order());
+			EXPECT_EQ(trades[i].get_volume(), expected[i].get_volume());
+		}
+	}
+	std::remove(path.c_str());
+}
+
+TEST(snapshot_test, invalid_files_are_refused) {
+	std::string path = ::testing::TempDir() + "book.snapshot";
+	Book book;
+	book.place_order(1, 1, BUY, 100, 10);
+	book.place_order(2, 1, SELL, 101, 10);
+	ASSERT_TRUE(book.save_snapshot(path));
+	Book missing;
+	EXPECT_FALSE(missing.load_snapshot(path + ".missing"));
+
+	// Header, buy level at 32, its order at 48, sell level at 80, its order at 96
+	std::string original(128, '\0');
+	std::ifstream(path, std::ios::binary).read(original.data(), 128);
+	auto refused = [&path, &original](std::size_t offset, std::uint64_t value) {
+		std::string patched = original;
+		std::memcpy(patched.data() + offset, &value, sizeof(value));
+		std::ofstream(path, std::ios::binary).write(patched.data(), static_cast<std::streamsize>(patched.size()));
+		Book book;
+		return not book.load_snapshot(path) and book.get_id_to_order().empty() and book.get_best_buy() == 0
+				and book.get_best_sell() == 0 and book.get_levels(BUY).empty();
+	};
+	EXPECT_TRUE(refused(16, std::uint64_t(1) << 62)); // nb_levels: the size check must not overflow
+	EXPECT_TRUE(refused(40, 2)); // Level counts no longer add up to the header, the next level header is misplaced
+	EXPECT_TRUE(refused(112, 0)); // Order of volume 0 in the second level: the first one is loaded, then removed
+	EXPECT_TRUE(refused(96, 1)); // Sell order given the id of the buy order: the duplicate empties the book as well
+
+	// Truncated: the size announced by the header does not match
+	std::ofstream(path, std::ios::binary).write(original.data(), 127);
+	Book truncated;
+	EXPECT_FALSE(truncated.load_snapshot(path));
+	EXPECT_TRUE(truncated.get_id_to_order().empty());
+	std::remove(path.c_str());
+}
+
+TEST(journal_test, replayed_journal_gives_the_same_trades) {
+	Commands commands = random_commands(11, 4000, 500);
+	std::string path = ::testing::TempDir() + "book.journal";
+	std::remove(path.c_str());
+	Book original;
+	Trades expected;
+	{
+		Journal journal(false, std::chrono::microseconds(10));
+		ASSERT_TRUE(journal.open(path));
+		journal.start();
+		for (std::size_t first = 0; first < commands.size(); first += 100) {
+			std::span<const Command> window = std::span(commands).subspan(first, 100);
+			EXPECT_EQ(journal.append(window), first);
+			original.process_batch(window, [&expected](const Trade& trade) { expected.push_back(trade); });
+		}
+		EXPECT_TRUE(journal.wait_durable(commands.size() - 1));
+		journal.stop();
+		EXPECT_EQ(journal.get_durable(), commands.size());
+		EXPECT_GE(journal.get_commits(), 1u);
+		EXPECT_FALSE(journal.has_failed());
+	}
+
+	std::vector<SequencedCommand> records;
+	ASSERT_TRUE(Journal::read(path, records));
+	ASSERT_EQ(records.size(), commands.size());
+	Book replayed;
+	Trades trades;
+	for (std::size_t i = 0; i < records.size(); i++) {
+		EXPECT_EQ(records[i].sequence, i);
+		replayed.process_batch(std::span(&records[i].command, 1), [&trades](const Trade& trade) { trades.push_back(trade); });
+	}
+	ASSERT_EQ(trades.size(), expected.size());
+	for (std::size_t i = 0; i < trades.size(); i++) {
+		EXPECT_EQ(trades[i].get_incoming_order(), expected[i].get_incoming_order());
+		EXPECT_EQ(trades[i].get_matched_order(), expected[i].get_matched_order());
+		EXPECT_EQ(trades[i].get_price(), expected[i].get_price());
+		EXPECT_EQ(trades[i].get_volume(), expected[i].get_volume());
+	}
+	ASSERT_EQ(replayed.get_id_to_order().size(), original.get_id_to_order().size());
+	for (auto& [id, index] : original.get_id_to_order()) {
+		ASSERT_NE(replayed.get_order(id), nullptr);
+		EXPECT_EQ(replayed.get_order(id)->get_volume(), original.get_order(id)->get_volume());
+	}
+	std::remove(path.c_str());
+}
+
+TEST(journal_test, torn_record_is_cut_and_sequence_continues) {
+	std::string path = ::testing::TempDir() + "book.journal";
+	std::remove(path.c_str());
+	Commands commands = {{1, 1, 10, 100, PLACE, BUY, 0}, {2, 1, 10, 101, PLACE, SELL, 0}, {1, 0, 0, 0, CANCEL, BUY, 0}};
+	{
+		Journal journal;
+		ASSERT_TRUE(journal.open(path));
+		journal.start();
+		journal.append(commands);
+		journal.stop();
+	}
+	// Crash in the middle of the last record
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+	std::vector<SequencedCommand> records;
+	ASSERT_TRUE(Journal::read(path, records));
+	EXPECT_EQ(records.size(), 2u);
+
+	Journal journal;
+	ASSERT_TRUE(journal.open(path));
+	EXPECT_EQ(journal.get_durable(), 2u);
+	journal.start();
+	EXPECT_EQ(journal.append(commands[2]), 2u);
+	journal.stop();
+	records.clear();
+	ASSERT_TRUE(Journal::read(path, records));
+	ASSERT_EQ(records.size(), 3u);
+	EXPECT_EQ(records[2].sequence, 2u);
+	EXPECT_EQ(records[2].command.type, CANCEL);
+
+	std::filesystem::resize_file(path, 10); // Not even a header
+	EXPECT_FALSE(Journal::read(path, records));
+	EXPECT_FALSE(Journal().open(path));
+	std::remove(path.c_str());
+}
+
+// Matching Engine Tests
+TEST(spsc_ring_test, wraps_and_reports_full) {
+	SpscRing<int> ring(3); // Rounded up to 4
+	EXPECT_EQ(ring.get_capacity(), 4u);
+	int value = 0;
+	for (int round = 0; round < 3; round++) {
+		for (int i = 0; i < 4; i++)
+			EXPECT_TRUE(ring.try_push(round * 4 + i));
+		EXPECT_FALSE(ring.try_push(-1));
+		EXPECT_TRUE(ring.try_pop(value));
+		EXPECT_EQ(value, round * 4);
+		int rest[4];
+		EXPECT_EQ(ring.try_pop_bulk(rest, 4), 3u);
+		EXPECT_EQ(rest[2], round * 4 + 3);
+		EXPECT_FALSE(ring.try_pop(value));
+	}
+}
+
+TEST(engine_test, symbols_are_routed_to_their_books) {
+	EngineConfig config;
+	config.nb_workers = 3;
+	config.pin_threads = false;
+	config.ring_capacity = 64; // Smaller than the flow: submit has to wait for the workers
+	MatchingEngine engine(config);
+
+	std::mt19937_64 rng(7);
+	Commands commands(3000);
+	for (Command& command : commands) {
+		command.symbol = rng() % 8;
+		command.id = 1 + rng() % 200;
+		command.type = rng() % 4 ? PLACE : CANCEL;
+		command.side = OrderType(rng() % 2);
+		command.price = 95 + rng() % 10;
+		command.volume = 1 + rng() % 20;
+	}
+
+	std::vector<EngineResult> results;
+	std::vector<EngineTrade> trades;
+	auto drain = [&engine, &results, &trades]() {
+		EngineResult buffer[32];
+		EngineTrade trade_buffer[32];
+		for (std::size_t worker = 0; worker < engine.get_nb_workers(); worker++) {
+			for (std::size_t count; (count = engine.poll_trades(worker, trade_buffer, 32)) > 0;)
+				trades.insert(trades.end(), trade_buffer, trade_buffer + count);
+			for (std::size_t count; (count = engine.poll_results(worker, buffer, 32)) > 0;)
+				results.insert(results.end(), buffer, buffer + count);
+		}
+	};
+	engine.start();
+	for (const Command& command : commands)
+		while (not engine.submit(command))
+			drain();
+	while (results.size() < commands.size()) // The workers wait for room on the result rings, stop would wait for them
+		drain();
+	engine.stop();
+	drain(); // Trades pushed before the last results
+	EXPECT_EQ(results.size(), commands.size());
+
+	for (Symbol symbol = 0; symbol < 8; symbol++) {
+		Book expected;
+		Length nb_results = 0;
+		Trades expected_trades;
+		for (const Command& command : commands) {
+			if (command.symbol != symbol) continue;
+			nb_results++;
+			if (command.type == PLACE)
+				expected.place_order(command.id, 0, command.side, command.price, command.volume, expected_trades);
+			else
+				expected.delete_order(command.id);
+		}
+		std::vector<EngineTrade> symbol_trades;
+		std::copy_if(trades.begin(), trades.end(), std::back_inserter(symbol_trades), [symbol](const EngineTrade& trade) { return trade.symbol == symbol; });
+		ASSERT_EQ(symbol_trades.size(), expected_trades.size());
+		for (std::size_t i = 0; i < symbol_trades.size(); i++) {
+			EXPECT_EQ(symbol_trades[i].incoming_order, expected_trades[i].get_incoming_order());
+			EXPECT_EQ(symbol_trades[i].matched_order, expected_trades[i].get_matched_order());
+			EXPECT_EQ(symbol_trades[i].price, expected_trades[i].get_price());
+			EXPECT_EQ(symbol_trades[i].volume, expected_trades[i].get_volume());
+		}
+		Book* book = engine.get_book(symbol);
+		ASSERT_NE(book, nullptr);
+		EXPECT_EQ(book->get_id_to_order().size(), expected.get_id_to_order().size());
+		EXPECT_EQ(book->get_best_buy(), expected.get_best_buy());
+		EXPECT_EQ(book->get_best_sell(), expected.get_best_sell());
+		EXPECT_EQ(static_cast<Length>(std::count_if(results.begin(), results.end(), [symbol](const EngineResult& result) { return result.symbol == symbol; })), nb_results);
+	}
+	EXPECT_EQ(engine.get_book(8), nullptr);
+}
+
+TEST(engine_test, stopped_without_polling_the_results) {
+	EngineConfig config;
+	config.pin_threads = false;
+	config.ring_capacity = 64;
+	MatchingEngine engine(config);
+	engine.start();
+	// Nobody polls: the result ring fills, then the command ring, and submit starts refusing
+	std::size_t accepted = 0;
+	for (ID id = 1; id <= 200; id++)
+		accepted += engine.submit({id, 0, 10, 100, PLACE, BUY, 0});
+	engine.stop();
+
+	EngineResult buffer[64];
+	std::size_t published = engine.poll_results(0, buffer, 64);
+	EXPECT_EQ(engine.get_dropped_trades(0), 0u); // Nothing crossed
+	EXPECT_EQ(published, 64u);
+	EXPECT_EQ(published + engine.get_dropped_results(0), accepted);
+	EXPECT_EQ(engine.get_book(0)->get_id_to_order().size(), accepted);
+
+	// Same without stopping first: the destructor must not wait for a consumer either
+	MatchingEngine destroyed(config);
+	destroyed.start();
+	for (ID id = 1; id <= 200; id++)
+		destroyed.submit({id, 0, 10, 100, PLACE, BUY, 0});
+}
+
+// Sequencer Tests
+TEST(sequencer_test, producers_are_totally_ordered) {
+	constexpr ID NB_PRODUCERS = 4;
+	constexpr ID PER_PRODUCER = 500;
+	Book book;
+	std::vector<SequencedCommand> log;
+	Trades trades;
+	bool trades_attributed = true;
+	Sequencer sequencer(book, 256, [&](std::span<const SequencedCommand> commands, std::span<const PlaceResult> results, std::span<const Trade> batch_trades) {
+		log.insert(log.end(), commands.begin(), commands.end());
+		// The trades of each command follow each other, as many as its fills
+		std::size_t next = 0;
+		for (std::size_t i = 0; i < commands.size(); i++)
+			for (Length fill = 0; fill < results[i].fills; fill++, next++)
+				trades_attributed = trades_attributed and next < batch_trades.size() and batch_trades[next].get_incoming_order() == commands[i].command.id;
+		trades_attributed = trades_attributed and next == batch_trades.size();
+		trades.insert(trades.end(), batch_trades.begin(), batch_trades.end());
+	});
+	sequencer.start();
+	std::vector<std::thread> producers;
+	for (ID producer = 0; producer < NB_PRODUCERS; producer++) {
+		producers.emplace_back([&sequencer, producer]() {
+			for (ID i = 0; i < PER_PRODUCER; i++) {
+				ID id = producer * PER_PRODUCER + i / 2 + 1;
+				Price price = 100 + static_cast<Price>(i % 7) - static_cast<Price>(producer % 2) * 5;
+				sequencer.submit({id, producer, 10, price, i % 2 ? CANCEL : PLACE, producer % 2 ? BUY : SELL, 0});
+			}
+		});
+	}
+	for (std::thread& producer : producers)
+		producer.join();
+	sequencer.submit({999998, 0, 5, 100, PLACE, SELL, 0});
+	std::uint64_t last = sequencer.submit({999999, 0, 5, 100, PLACE, BUY, 0}); // Trades whatever the interleaving
+	sequencer.wait_for(last);
+	EXPECT_EQ(sequencer.get_executed(), NB_PRODUCERS * PER_PRODUCER + 2);
+	sequencer.stop();
+
+	ASSERT_EQ(log.size(), NB_PRODUCERS * PER_PRODUCER + 2);
+	EXPECT_TRUE(trades_attributed);
+	Book expected;
+	Trades expected_trades;
+	std::vector<ID> last_id(NB_PRODUCERS, 0);
+	for (std::size_t i = 0; i < log.size(); i++) {
+		EXPECT_EQ(log[i].sequence, i);
+		const Command& command = log[i].command;
+		if (command.id < 999998) {
+			EXPECT_GE(command.id, last_id[command.agent_id]); // Each producer's commands keep their order
+			last_id[command.agent_id] = command.id;
+		}
+		expected.process_batch(std::span(&command, 1), [&expected_trades](const Trade& trade) { expected_trades.push_back(trade); });
+	}
+	ASSERT_EQ(trades.size(), expected_trades.size());
+	EXPECT_FALSE(trades.empty());
+	for (std::size_t i = 0; i < trades.size(); i++) {
+		EXPECT_EQ(trades[i].get_matched_order(), expected_trades[i].get_matched_order());
+		EXPECT_EQ(trades[i].get_volume(), expected_trades[i].get_volume());
+	}
+	EXPECT_EQ(book.get_id_to_order().size(), expected.get_id_to_order().size());
+	EXPECT_EQ(book.get_best_buy(), expected.get_best_buy());
+	EXPECT_EQ(book.get_best_sell(), expected.get_best_sell());
+}
+
+// Latency histogram Tests
+TEST(latency_histogram_test, buckets) {
+	using H = LatencyHistogram;
+	// Exact below 2 * SUB_BUCKETS
+	for (std::uint64_t value = 0; value < 2 * H::SUB_BUCKETS; value++) {
+		EXPECT_EQ(H::bucket_of(value), value);
+		EXPECT_EQ(H::highest_of(value), value);
+	}
+	// Each bucket holds the values up to its highest one, the next bucket starts right after
+	for (std::size_t bucket = 0; bucket < H::NB_BUCKETS; bucket++) {
+		ASSERT_EQ(H::bucket_of(H::highest_of(bucket)), bucket);
+		if (bucket + 1 < H::NB_BUCKETS) {
+			ASSERT_EQ(H::bucket_of(H::highest_of(bucket) + 1), bucket + 1);
+		}
+	}
+	// Powers of two open a bucket
+	for (unsigned bit = 6; bit < 64; bit++) {
+		std::uint64_t power = std::uint64_t(1) << bit;
+		EXPECT_EQ(H::bucket_of(power), H::bucket_of(power - 1) + 1);
+		EXPECT_EQ(H::bucket_of(power) % H::SUB_BUCKETS, 0u);
+	}
+	EXPECT_EQ(H::highest_of(H::NB_BUCKETS - 1), UINT64_MAX);
+	EXPECT_EQ(H::bucket_of(UINT64_MAX), H::NB_BUCKETS - 1);
+	// Any value is known within 1 / SUB_BUCKETS
+	std::mt19937_64 rng(8);
+	for (int i = 0; i < 100000; i++) {
+		std::uint64_t value = rng() >> (rng() % 58);
+		if (value < 2 * H::SUB_BUCKETS)
+			continue;
+		std::uint64_t highest = H::highest_of(H::bucket_of(value));
+		ASSERT_GE(highest, value);
+		ASSERT_LE(highest - value, value / H::SUB_BUCKETS) << value;
+	}
+}
+
+TEST(latency_histogram_test, percentiles) {
+	LatencyHistogram histogram;
+	EXPECT_EQ(histogram.get_percentile(50), 0u);
+	EXPECT_EQ(histogram.get_min(), 0u);
+	for (std::uint64_t value = 1; value <= 100; value++)
+		histogram.record(value);
+	EXPECT_EQ(histogram.get_total(), 100u);
+	EXPECT_EQ(histogram.get_min(), 1u);
+	EXPECT_EQ(histogram.get_max(), 100u);
+	// Rank ceil(p * total), at least 1
+	EXPECT_EQ(histogram.get_percentile(0), 1u);
+	EXPECT_EQ(histogram.get_percentile(50), 50u);
+	EXPECT_EQ(histogram.get_percentile(50.5), 51u);
+	EXPECT_EQ(histogram.get_percentile(99), 99u);
+	EXPECT_EQ(histogram.get_percentile(100), 100u);
+	// 100 shares its bucket with 101: the bucket bound is clamped to the max
+	EXPECT_EQ(histogram.get_percentile(99.5), 100u);
+
+	// Values above 64 are reported as the highest value of their bucket
+	LatencyHistogram wide;
+	for (int i = 0; i < 90; i++)
+		wide.record(10);
+	for (int i = 0; i < 10; i++)
+		wide.record(1000);
+	wide.record(5000);
+	EXPECT_EQ(wide.get_percentile(50), 10u);
+	EXPECT_EQ(wide.get_percentile(95), LatencyHistogram::highest_of(LatencyHistogram::bucket_of(1000)));
+	EXPECT_EQ(wide.get_percentile(100), 5000u);
+}
+
+// Operation reader Tests
+namespace {
+
+/** Leading digits of a field, as parse_operations reads them */
+std::uint64_t naive_number(const std::string& field) {
+	std::uint64_t value = 0;
+	for (char c : field) {
+		if (c < '0' or c > '9')
+			break;
+		value = value * 10 + (c - '0');
+	}
+	return value;
+}
+
+/** Line by line reference decoder of an operations CSV */
+Commands naive_parse(const std::string& text) {
+	Commands commands;
+	std::istringstream stream(text);
+	std::string line;
+	if (text.find('\n') == std::string::npos or not std::getline(stream, line)) // Header
+		return commands;
+	while (std::getline(stream, line)) {
+		std::vector<std::string> fields(1);
+		for (char c : line) {
+			if (c == ',')
+				fields.emplace_back();
+			else
+				fields.back() += c;
+		}
+		char operation = fields[0].empty() ? '\0' : fields[0][0];
+		if (fields.size() < 2 or (operation != 'P' and operation != 'D' and operation != 'A'))
+			continue;
+		Command command{};
+		command.type = operation == 'P' ? PLACE : operation == 'D' ? CANCEL : AMEND;
+		command.id = naive_number(fields[1]);
+		if (fields.size() > 2 and command.type != CANCEL)
+			command.side = naive_number(fields[2]) == BUY ? BUY : SELL;
+		if (fields.size() > 3)
+			command.price = static_cast<Price>(naive_number(fields[3]));
+		if (fields.size() > 4)
+			command.volume = naive_number(fields[4]);
+		commands.push_back(command);
+	}
+	return commands;
+}
+
+} // namespace
+
+TEST(operation_reader_test, block_scanner_matches_a_line_by_line_decode) {
+	// Every kind of line, "\n" or "\r\n" endings, numbers of varying width so that separators fall on every position
+	std::mt19937_64 rng(3);
+	std::string text = "operation,id,type,price,volume\n";
+	for (int line = 0; line < 80; line++) {
+		std::string id = std::to_string(1 + rng() % 100000);
+		switch (rng() % 6) {
+			case 0: text += "DELETE," + id + ",,,"; break;
+			case 1: text += "AMEND," + id + "," + std::to_string(rng() % 2) + "," + std::to_string(rng() % 1000) + ",7"; break;
+			case 2: text += "UNKNOWN," + id + ",0,10,10"; break;
+			case 3: text += rng() % 2 ? "" : "PLACE"; break;
+			default:
+				text += "PLACE," + id + "," + std::to_string(rng() % 2) + "," + std::to_string(1 + rng() % 100000) + ","
+						+ std::to_string(1 + rng() % 1000);
+		}
+		text += rng() % 3 ? "\n" : "\r\n";
+	}
+	ASSERT_GT(text.size(), 64u * 12);
+	// Every prefix: the tail block is zero-padded at each possible length and the last line may lack its "\n"
+	for (std::size_t size = 0; size <= text.size(); size++) {
+		std::string prefix = text.substr(0, size);
+		Commands parsed;
+		std::size_t count = parse_operations(prefix, parsed);
+		Commands expected = naive_parse(prefix);
+		ASSERT_EQ(count, expected.size()) << "prefix of " << size << " bytes";
+		ASSERT_EQ(parsed.size(), expected.size()) << "prefix of " << size << " bytes";
+		for (std::size_t i = 0; i < parsed.size(); i++) {
+			ASSERT_TRUE(parsed[i].id == expected[i].id and parsed[i].type == expected[i].type and parsed[i].side == expected[i].side
+					and parsed[i].price == expected[i].price and parsed[i].volume == expected[i].volume)
+					<< "command " << i << " of a prefix of " << size << " bytes";
+		}
+	}
+}
+
+// Lobbin Tests
+TEST(lobbin_test, round_trip) {
+	const std::string path = ::testing::TempDir() + "round_trip.lobbin";
+	Commands commands = random_commands(12, 1000, 300);
+	commands.push_back({UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT32_MAX, AMEND, SELL, UINT16_MAX});
+	ASSERT_TRUE(write_lobbin(path, commands));
+	{
+		LobbinFile file;
+		ASSERT_TRUE(file.open(path));
+		std::span<const Command> read = file.get_commands();
+		ASSERT_EQ(read.size(), commands.size());
+		EXPECT_EQ(std::memcmp(read.data(), commands.data(), commands.size() * sizeof(Command)), 0);
+	}
+	// An empty flow is a valid file
+	ASSERT_TRUE(write_lobbin(path, {}));
+	LobbinFile empty;
+	ASSERT_TRUE(empty.open(path));
+	EXPECT_TRUE(empty.get_commands().empty());
+	std::remove(path.c_str());
+}
+
+TEST(lobbin_test, invalid_files_are_refused) {
+	const std::string path = ::testing::TempDir() + "invalid.lobbin";
+	ASSERT_TRUE(write_lobbin(path, random_commands(13, 10, 100)));
+	std::string bytes;
+	{
+		std::ifstream in(path, std::ios::binary);
+		bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+	ASSERT_EQ(bytes.size(), sizeof(LobbinHeader) + 10 * sizeof(Command));
+	auto refused = [&](const std::string& content) {
+		std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+		LobbinFile file;
+		return not file.open(path);
+	};
+	EXPECT_FALSE(refused(bytes));
+
+	std::string bad_magic = bytes;
+	bad_magic[0] = 'X';
+	EXPECT_TRUE(refused(bad_magic));
+	EXPECT_TRUE(refused(bytes.substr(0, bytes.size() - 1))); // Truncated record
+	EXPECT_TRUE(refused(bytes.substr(0, bytes.size() - sizeof(Command)))); // Whole record missing: count mismatch
+	EXPECT_TRUE(refused(bytes.substr(0, sizeof(LobbinHeader) - 1))); // Truncated header
+	std::string bad_version = bytes;
+	bad_version[offsetof(LobbinHeader, version)] = 2;
+	EXPECT_TRUE(refused(bad_version));
+	EXPECT_FALSE(LobbinFile().open(::testing::TempDir() + "missing.lobbin"));
+	std::remove(path.c_str());
 }
 
 // Main function to run the tests